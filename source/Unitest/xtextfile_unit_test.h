@@ -1,5 +1,9 @@
 #include <format>
 #include <iostream>
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
 
 namespace xtextfile::unit_test
 {
@@ -107,19 +111,11 @@ namespace xtextfile::unit_test
                     assert(WStringBack[i] == WString[i]);
 
                     //
-                    // If we tell the file system to write floats as floats then we will leak precision
-                    // so we need to take that into account when checking.
+                    // Floats written as floats use the shortest form that reads back to the same value
+                    // so they must match exactly just like the hex ones.
                     //
-                    if (Flags.m_isWriteFloats)
-                    {
-                        assert(AlmostEqualRelative(Floats64Back[i], Floats64[i]));
-                        assert(AlmostEqualRelative(Floats32Back[i], Floats32[i]));
-                    }
-                    else
-                    {
-                        assert(Floats64Back[i] == Floats64[i]);
-                        assert(Floats32Back[i] == Floats32[i]);
-                    }
+                    assert(Floats64Back[i] == Floats64[i]);
+                    assert(Floats32Back[i] == Floats32[i]);
 
                     assert(Int64Back[i] == Int64[i]);
                     assert(Int32Back[i] == Int32[i]);
@@ -202,19 +198,11 @@ namespace xtextfile::unit_test
         if (isRead)
         {
             //
-            // If we tell the file system to write floats as floats then we will leak precision
-            // so we need to take that into account when checking.
+            // Floats written as floats use the shortest form that reads back to the same value
+            // so they must match exactly just like the hex ones.
             //
-            if (Flags.m_isWriteFloats)
-            {
-                assert(AlmostEqualRelative(Floats64Back[0], Floats64[0]));
-                assert(AlmostEqualRelative(Floats32Back[0], Floats32[0]));
-            }
-            else
-            {
-                assert(Floats64Back[0] == Floats64[0]);
-                assert(Floats32Back[0] == Floats32[0]);
-            }
+            assert(Floats64Back[0] == Floats64[0]);
+            assert(Floats32Back[0] == Floats32[0]);
 
             assert(StringBack[0] == String[0]);
             assert(Int64Back[0] == Int64[0]);
@@ -355,77 +343,1574 @@ namespace xtextfile::unit_test
     }
 
     //------------------------------------------------------------------------------
-    // Test different types
+    // Reading only some of the columns
     //------------------------------------------------------------------------------
     inline
-    xerr Test01(std::wstring_view FileName, bool isRead, xtextfile::file_type FileType, xtextfile::flags Flags) noexcept
+    xerr ColumnSelection(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
     {
-        xtextfile::stream   TextFile;
+        constexpr xtextfile::user_defined_types v3{ "V3", "fff" };
+
+        std::array<std::string, 3>  String  = { StringBack[0], StringBack[1], StringBack[2] };
+        auto                        Floats64= Floats64Back;
+        auto                        Int32   = Int32Back;
+        auto                        Int16   = Int16Back;
+        std::array                  Position= { 0.1f, 0.5f, 0.6f };
+
+        if (auto Err = TextFile.WriteComment(
+            "----------------------------------------------------\n"
+            " Example that shows how to read only some of the columns\n"
+            "----------------------------------------------------\n"
+        ); Err) return Err;
+
+        TextFile.AddUserType(v3);
 
         //
-        // Open File
+        // When reading tell the file which columns we care about, the rest will be skipped
         //
-        if (auto Err = TextFile.Open(isRead, FileName, FileType, Flags); Err)
-        {
-            std::cout << "Failed to open " << Err.getMessage() << "\n";
-            return Err;
-        }
+        if (isRead) TextFile.SelectColumns({ "Ints", "Value:?" });
 
-        //
-        // Run tests
-        // 
-        if (auto Err = AllTypes(TextFile, isRead, Flags); Err) 
-            return Err;
+        if (auto Err = TextFile.Record("ColumnSelection"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == StringBack.size());
+                else        C = StringBack.size();
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                if (isRead)
+                {
+                    Int32[i] = 0;
+                    Int16[i] = 0;
 
-        if (auto Err = SimpleVariableTypes(TextFile, isRead, Flags); Err) 
-            return Err;
+                    // A column that was not selected can not be read
+                    if (Error = TextFile.Field("String", String[i]); Error.getState<xtextfile::state>() != xtextfile::state::FIELD_NOT_FOUND)
+                    {
+                        assert(false);
+                        return;
+                    }
+                    Error.clear();
+                }
+                else
+                {
+                    if (Error = TextFile.Field("String", String[i]); Error) return;
+                    if (Error = TextFile.Field(v3.m_CRC, "Position", Position[0], Position[1], Position[2]); Error) return;
+                    if (Error = TextFile.Field("Floats", Floats64[i]); Error) return;
+                }
 
-        if (auto Err = UserTypes(TextFile, isRead, Flags); Err ) 
-            return Err;
-      
-        if (auto Err = Properties(TextFile, isRead, Flags); Err ) 
-            return Err;
+                if (Error = TextFile.Field("Ints", Int32[i], Int16[i]); Error) return;
 
-        //
-        // When we are reading and we are done dealing with records we can check if we are done reading a file like this
-        //
-        if (isRead && TextFile.isEOF())
-            return {};
+                switch (i)
+                {
+                case 0: if (Error = TextFile.Field("Value:?", Int32[i]); Error) return; break;
+                case 1: if (Error = TextFile.Field("Value:?", Int16[i]); Error) return; break;
+                case 2: if (Error = TextFile.Field(v3.m_CRC, "Value:?", Position[0], Position[1], Position[2]); Error) return; break;
+                }
+
+                if (isRead)
+                {
+                    assert(Int32Back[i] == Int32[i]);
+                    assert(Int16Back[i] == Int16[i]);
+                }
+            }
+        ); Err) return Err;
 
         return {};
     }
 
-    //-----------------------------------------------------------------------------------------
+    //------------------------------------------------------------------------------
+    // Skipping lines while reading
+    //------------------------------------------------------------------------------
+    inline
+    xerr RowFilter(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        constexpr int   Times = 100;
+        std::int32_t    Key;
+        double          Value;
+        std::string     Name;
+        int             nRows = 0;
 
-    void Test(void)
+        if (auto Err = TextFile.WriteComment(
+            "----------------------------------------------------\n"
+            " Example that shows how to skip lines while reading\n"
+            "----------------------------------------------------\n"
+        ); Err) return Err;
+
+        if (auto Err = TextFile.RecordFilter("RowFilter"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times);
+                else        C = Times;
+            }
+            , [&](std::size_t, xerr& Error) -> bool
+            {
+                // Only the key gets decoded for the lines we skip
+                if (Error = TextFile.Field("Key", Key); Error) return false;
+                return (Key % 10) == 0;
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                if (isRead == false)
+                {
+                    Key   = static_cast<std::int32_t>(i);
+                    Value = Floats64Back[i % Floats64Back.size()];
+                    Name  = StringBack[i % StringBack.size()];
+                    if (Error = TextFile.Field("Key", Key); Error) return;
+                }
+
+                if (Error = TextFile.Field("Name", Name); Error) return;
+                if (Error = TextFile.Field("Value", Value); Error) return;
+
+                if (isRead)
+                {
+                    assert(Key == static_cast<std::int32_t>(i));
+                    assert(Name == StringBack[i % StringBack.size()]);
+                    assert(Floats64Back[i % Floats64Back.size()] == Value);
+                }
+                nRows++;
+            }
+        ); Err) return Err;
+
+        assert(nRows == (isRead ? Times / 10 : Times));
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Writing a record without knowing how many lines it will have
+    //------------------------------------------------------------------------------
+    inline
+    xerr StreamedRecord(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
     {
-        constexpr static auto FileName = L"./x64/TextFileTest.la";
-        xerr Error;
+        constexpr int   Times = 150;
+        int             nRows = 0;
+
+        if (auto Err = TextFile.WriteComment(
+            "----------------------------------------------------\n"
+            " Example of a record written without its count\n"
+            "----------------------------------------------------\n"
+        ); Err) return Err;
+
+        if (auto Err = TextFile.RecordStream("Streamed"
+            , [&](xerr&) -> bool
+            {
+                // A generator would say false when it runs out of values
+                return nRows < Times;
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                std::int64_t Value = static_cast<std::int64_t>(i) * 1000003;
+                std::string  Name  = StringBack[i % StringBack.size()];
+
+                if (Error = TextFile.Field("Value", Value); Error) return;
+                if (Error = TextFile.Field("Name", Name); Error) return;
+
+                if (isRead)
+                {
+                    assert(Value == static_cast<std::int64_t>(i) * 1000003);
+                    assert(Name == StringBack[i % StringBack.size()]);
+                }
+                nRows++;
+            }
+        ); Err) return Err;
+
+        assert(nRows == Times);
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Several threads writing the rows of the same record
+    //------------------------------------------------------------------------------
+    inline
+    xerr ConcurrentRecords(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        constexpr int   Times       = 200;
+        constexpr int   nThreads    = 4;
+        constexpr int   nBlockRows  = 16;
+
+        if (auto Err = TextFile.WriteComment(
+            "----------------------------------------------------\n"
+            " Example of records written by several threads\n"
+            "----------------------------------------------------\n"
+        ); Err) return Err;
+
         //
-        // Test write and read (Text Style)
+        // Rows in order, each thread does every nThreads-th block
         //
-        if (true) if (0
-            || (Error = Test01(std::format(L"{}{}.txt", FileName, 1).c_str(), false, xtextfile::file_type::TEXT, {xtextfile::flags{}}))
-            || (Error = Test01(std::format(L"{}{}.txt", FileName, 1).c_str(), true,  xtextfile::file_type::TEXT, { xtextfile::flags{} }))
-            || (Error = Test01(std::format(L"{}{}.txt", FileName, 2).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteFloats = true }))
-            || (Error = Test01(std::format(L"{}{}.txt", FileName, 2).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteFloats = true }))
-            )
+        if (isRead)
         {
-            assert(false);
+            if (auto Err = TextFile.Record("Concurrent"
+                , [&](std::size_t& C, xerr&)
+                {
+                    assert(C == Times);
+                }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    std::int32_t Key;
+                    std::string  Name;
+                    if (Error = TextFile.Field("Key", Key); Error) return;
+                    if (Error = TextFile.Field("Name", Name); Error) return;
+                    assert(Key == static_cast<std::int32_t>(i));
+                    assert(Name == StringBack[i % StringBack.size()]);
+                }
+            ); Err) return Err;
+        }
+        else
+        {
+            if (auto Err = TextFile.BeginConcurrentRecord("Concurrent", Times); Err) return Err;
+
+            std::vector<std::thread> Threads;
+            std::vector<xerr>        Errors(nThreads);
+            for (int t = 0; t < nThreads; ++t)
+            {
+                Threads.emplace_back([&, t]
+                {
+                    for (int iStart = t * nBlockRows; iStart < Times && !Errors[t]; iStart += nThreads * nBlockRows)
+                    {
+                        xtextfile::row_block Rows{ static_cast<std::size_t>(iStart) };
+                        for (int i = iStart; i < std::min(iStart + nBlockRows, Times); ++i)
+                        {
+                            Rows.Field("Key", static_cast<std::int32_t>(i));
+                            Rows.Field("Name", std::string{ StringBack[i % StringBack.size()] });
+                            Rows.EndRow();
+                        }
+                        Errors[t] = TextFile.SubmitRows(Rows);
+                    }
+                });
+            }
+            for (auto& T : Threads) T.join();
+            for (auto& E : Errors) if (E) return E;
+
+            if (auto Err = TextFile.EndConcurrentRecord(); Err) return Err;
         }
 
         //
-        // Test write and read (Binary Style)
+        // Log style, the rows go in as they come and nobody knows the count
         //
-        if (true) if (0
-            || (Error = Test01(std::format(L"{}{}.bin", FileName, 1).c_str(), false, xtextfile::file_type::BINARY, { xtextfile::flags{} }))
-            || (Error = Test01(std::format(L"{}{}.bin", FileName, 1).c_str(), true, xtextfile::file_type::BINARY, { xtextfile::flags{} }))
-            || (Error = Test01(std::format(L"{}{}.bin", FileName, 2).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteFloats = true }))
-            || (Error = Test01(std::format(L"{}{}.bin", FileName, 2).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteFloats = true }))
-            )
+        if (isRead)
         {
-            assert(false);
+            std::vector<int> Seen(nThreads * Times / 10, 0);
+            if (auto Err = TextFile.Record("ConcurrentLog"
+                , [&](std::size_t& C, xerr&)
+                {
+                    assert(C == Seen.size());
+                }
+                , [&](std::size_t, xerr& Error)
+                {
+                    std::int32_t Key;
+                    if (Error = TextFile.Field("Key", Key); Error) return;
+                    Seen[Key]++;
+                }
+            ); Err) return Err;
+
+            for (auto S : Seen) assert(S == 1);
+        }
+        else
+        {
+            if (auto Err = TextFile.BeginConcurrentRecord("ConcurrentLog", 0, true); Err) return Err;
+
+            std::vector<std::thread> Threads;
+            std::vector<xerr>        Errors(nThreads);
+            for (int t = 0; t < nThreads; ++t)
+            {
+                Threads.emplace_back([&, t]
+                {
+                    xtextfile::row_block Rows;
+                    for (int i = 0; i < Times / 10 && !Errors[t]; ++i)
+                    {
+                        Rows.Field("Key", static_cast<std::int32_t>(t * Times / 10 + i));
+                        Rows.EndRow();
+                        if (Rows.getRowCount() == 3) Errors[t] = TextFile.SubmitRows(Rows);
+                    }
+                    if (!Errors[t]) Errors[t] = TextFile.SubmitRows(Rows);
+                });
+            }
+            for (auto& T : Threads) T.join();
+            for (auto& E : Errors) if (E) return E;
+
+            if (auto Err = TextFile.EndConcurrentRecord(); Err) return Err;
         }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Independent records written by worker threads
+    //------------------------------------------------------------------------------
+    inline
+    xerr ParallelRecords(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        constexpr int   nJobs = 8;
+        constexpr int   Times = 70;
+
+        // Added before the jobs so it is written once ahead of all of them
+        constexpr xtextfile::user_defined_types v4{ "V4", "ffff" };
+        TextFile.AddUserType(v4);
+
+        // Added by the jobs, each one adds them in its own order
+        constexpr static std::array JobTypes
+        { xtextfile::user_defined_types{ "J2", "ff" }
+        , xtextfile::user_defined_types{ "J3", "fff" }
+        , xtextfile::user_defined_types{ "JD", "FF" }
+        };
+
+        if (auto Err = TextFile.WriteComment(
+            "----------------------------------------------------\n"
+            " Example of records written in parallel\n"
+            "----------------------------------------------------\n"
+        ); Err) return Err;
+
+        return TextFile.RecordsParallel(nJobs, [&](std::size_t iJob, xtextfile::stream& File, xerr& Error)
+        {
+            if (Error = File.Record("Chunk"
+                , [&](std::size_t& C, xerr&)
+                {
+                    if (isRead) assert(C == Times);
+                    else        C = Times;
+                }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    std::int32_t    Key         = static_cast<std::int32_t>(iJob * 1000 + i);
+                    std::array      Quaternion  = { static_cast<float>(iJob), static_cast<float>(i), 0.5f, 1.0f };
+
+                    if (Error = File.Field("Key", Key); Error) return;
+                    if (Error = File.Field(v4.m_CRC, "Rotation", Quaternion[0], Quaternion[1], Quaternion[2], Quaternion[3]); Error) return;
+
+                    if (isRead)
+                    {
+                        assert(Key == static_cast<std::int32_t>(iJob * 1000 + i));
+                        assert(Quaternion[0] == static_cast<float>(iJob));
+                        assert(Quaternion[1] == static_cast<float>(i));
+                    }
+                }
+            ); Error) return;
+
+            // Binary files patch the count of these in memory (the longer ones are written
+            // in blocks of 64 rows before the count is known)
+            constexpr std::array TailRows = { 1, 2, 3, 64, 65, 130, 200, 3 };
+            static_assert(TailRows.size() == nJobs);
+
+            const int nTail = TailRows[iJob];
+            int       nRows = 0;
+            Error = File.RecordStream("ChunkTail"
+                , [&](xerr&) -> bool { return nRows < nTail; }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    std::int32_t Key = static_cast<std::int32_t>(iJob * 1000 + i);
+                    if (Error = File.Field("Key", Key); Error) return;
+                    if (isRead) assert(Key == static_cast<std::int32_t>(iJob * 1000 + i));
+                    nRows++;
+                });
+            if (Error) return;
+            assert(nRows == nTail);
+
+            const auto& A = JobTypes[(iJob / 3) % JobTypes.size()];
+            const auto& B = JobTypes[iJob % JobTypes.size()];
+            File.AddUserType(A);
+            File.AddUserType(B);
+
+            auto TypedField = [&](const auto& Name, const xtextfile::user_defined_types& Type, std::size_t i) -> xerr
+            {
+                const float F = static_cast<float>(iJob * 10 + i);
+                float       X = isRead ? 0 : F, Y = isRead ? 0 : F + 1, Z = isRead ? 0 : F + 2;
+                double      D = isRead ? 0 : F * 0.5, E = isRead ? 0 : -F;
+
+                if (Type.m_CRC.m_Value == JobTypes[0].m_CRC.m_Value)
+                {
+                    if (auto Err = File.Field(Type.m_CRC, Name, X, Y); Err) return Err;
+                    if (isRead) assert(X == F && Y == F + 1);
+                }
+                else if (Type.m_CRC.m_Value == JobTypes[1].m_CRC.m_Value)
+                {
+                    if (auto Err = File.Field(Type.m_CRC, Name, X, Y, Z); Err) return Err;
+                    if (isRead) assert(X == F && Y == F + 1 && Z == F + 2);
+                }
+                else
+                {
+                    if (auto Err = File.Field(Type.m_CRC, Name, D, E); Err) return Err;
+                    if (isRead) assert(D == F * 0.5 && E == -F);
+                }
+                return {};
+            };
+
+            Error = File.Record("ChunkTypes"
+                , [&](std::size_t& C, xerr&)
+                {
+                    if (isRead) assert(C == 2);
+                    else        C = 2;
+                }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    if (Error = TypedField("A", A, i); Error) return;
+                    if (Error = TypedField("B", B, i); Error) return;
+                });
+        });
+    }
+
+    //------------------------------------------------------------------------------
+    // Values that stay the same down a column (written as ^ with m_isWriteRepeats)
+    //------------------------------------------------------------------------------
+    inline
+    xerr RepeatedValues(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags, const int iStart = 0) noexcept
+    {
+        constexpr int Times = 200;
+
+        return TextFile.Record("RepeatedValues"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times - iStart);
+                else        C = Times;
+            }
+            , [&](std::size_t iRow, xerr& Error)
+            {
+                const int           i        = static_cast<int>(iRow) + iStart;
+                const std::string   Material = std::format("Material{}", i / 50);
+                const std::int32_t  Flag     = (i / 30) % 2;
+                const float         Pos      = static_cast<float>(i / 7) * 0.5f;
+
+                std::string  M = Material;
+                std::int32_t F = Flag, Key = i;
+                float        X = Pos,  Y = 1.0f;
+                if (Error = TextFile.Field("Material", M); Error) return;
+                if (Error = TextFile.Field("Flag", F); Error) return;
+                if (Error = TextFile.Field("Pos", X, Y); Error) return;
+                if (Error = TextFile.Field("Key", Key); Error) return;
+
+                if (isRead)
+                {
+                    assert(M == Material);
+                    assert(F == Flag);
+                    assert(X == Pos && Y == 1.0f);
+                    assert(Key == i);
+                }
+            }
+        );
+    }
+
+    //------------------------------------------------------------------------------
+    // Many rows of fixed size fields (binary files read them in blocks of rows)
+    //------------------------------------------------------------------------------
+    inline
+    xerr FixedRows(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags) noexcept
+    {
+        constexpr int Times = 3000;
+
+        return TextFile.Record("FixedRows"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times);
+                else        C = Times;
+            }
+            , [&](std::size_t iRow, xerr& Error)
+            {
+                const int i = static_cast<int>(iRow);
+
+                std::uint8_t  Id  = static_cast<std::uint8_t>(i);
+                float         X   = static_cast<float>(i) * 0.25f;
+                double        D   = static_cast<double>(i) * 1.5;
+                std::int16_t  S   = static_cast<std::int16_t>(-i);
+                std::uint64_t Key = static_cast<std::uint64_t>(i) << 33;
+                if (Error = TextFile.Field("Id", Id); Error) return;
+                if (Error = TextFile.Field("Pos", X, D); Error) return;
+                if (Error = TextFile.Field("S", S); Error) return;
+                if (Error = TextFile.Field("Key", Key); Error) return;
+
+                if (isRead)
+                {
+                    assert(Id  == static_cast<std::uint8_t>(i));
+                    assert(X   == static_cast<float>(i) * 0.25f);
+                    assert(D   == static_cast<double>(i) * 1.5);
+                    assert(S   == static_cast<std::int16_t>(-i));
+                    assert(Key == static_cast<std::uint64_t>(i) << 33);
+                }
+            }
+        );
+    }
+
+    //------------------------------------------------------------------------------
+    // Floats written with the precision given in the field name (text files only, binary is exact)
+    //------------------------------------------------------------------------------
+    inline
+    xerr FloatPrecision(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags) noexcept
+    {
+        constexpr int Times = 70;
+
+        return TextFile.Record("FloatPrecision"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times);
+                else        C = Times;
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                const float  Temp     = static_cast<float>(i) * 1.37f - 20.123456f;
+                const double Pressure = 101325.0 + static_cast<double>(i) * 0.123456789;
+                const float  Exact    = static_cast<float>(i) / 3.0f;
+                const double Huge     = (i % 2 ? -1e300 : 1e100) * static_cast<double>(i + 1);
+
+                // Infinity and NaN are kept as their bits, with or without a precision
+                constexpr std::array<double, 4> Specials = { 1.5, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() };
+                const double Special  = Specials[i % Specials.size()];
+
+                float  T  = Temp,     E = Exact;
+                double P  = Pressure, H = Huge;
+                float  SF = static_cast<float>(Special), SE = SF;
+                double SD = Special;
+                if (Error = TextFile.Field("Temp:.3f", T); Error) return;
+                if (Error = TextFile.Field("Pressure:.4g", P); Error) return;
+                if (Error = TextFile.Field("Exact", E); Error) return;
+                if (Error = TextFile.Field("Huge:.3f", H); Error) return;
+                if (Error = TextFile.Field("SpecialF:.3f", SF); Error) return;
+                if (Error = TextFile.Field("SpecialD:.4g", SD); Error) return;
+                if (Error = TextFile.Field("SpecialE", SE); Error) return;
+
+                if (isRead)
+                {
+                    assert(std::abs(T - Temp) <= 0.0005f);
+                    assert(std::abs(P - Pressure) <= Pressure * 1e-3);
+                    assert(E == Exact);
+                    assert(H == Huge);
+
+                    auto isSame = [](double A, double B) { return std::isnan(A) ? std::isnan(B) : A == B; };
+                    assert(isSame(SF, Special));
+                    assert(isSame(SD, Special));
+                    assert(isSame(SE, Special));
+                }
+
+                // A precision that is not like :.3f is an error
+                if (isRead == false && i == 0)
+                {
+                    auto isBad = [&](const auto& Name) noexcept
+                    {
+                        xtextfile::stream Other;
+                        double            V = 1;
+                        if (Other.Open(false, L"./x64/TextFileTest.BadPrecision.txt", xtextfile::file_type::TEXT)) return false;
+
+                        return !!Other.Record("Bad"
+                            , [&](std::size_t& C, xerr&) { C = 1; }
+                            , [&](std::size_t, xerr& Err) { Err = Other.Field(Name, V); });
+                    };
+
+                    assert(isBad("Bad:3f"));
+                    assert(isBad("Bad:.f"));
+                    assert(isBad("Bad:.3x"));
+                    assert(isBad("Bad:.3ff"));
+                    assert(isBad("Bad:.41f"));
+                    assert(isBad("Bad:."));
+                    assert(isBad("Bad:.3f") == false);
+                }
+            }
+        );
+    }
+
+    //------------------------------------------------------------------------------
+    // Writing straight from const values, literals and string views (read back as strings)
+    //------------------------------------------------------------------------------
+    inline
+    xerr ConstFields(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags) noexcept
+    {
+        constexpr int                   Times   = 80;
+        constexpr std::string_view      Name    = "Const Name";
+        constexpr std::u16string_view   Wide    = u"Caf\u00E9 \\ View";
+        const     std::string           Long( 5000, 'x' );
+
+        return TextFile.Record("ConstFields"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times);
+                else        C = Times;
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                const std::int32_t Value = static_cast<std::int32_t>(i) * 3;
+
+                if (isRead)
+                {
+                    // Views can not be read into
+                    if (i == 0 && !TextFile.Field("Name", Name)) { Error = xerr::create_f<xtextfile::state, "Was able to read into a view">(); return; }
+
+                    std::int32_t    V;
+                    std::string     N, L, C;
+                    std::wstring    W;
+                    if (Error = TextFile.Field("Value", V); Error) return;
+                    if (Error = TextFile.Field("Name",  N); Error) return;
+                    if (Error = TextFile.Field("Wide",  W); Error) return;
+                    if (Error = TextFile.Field("Literal", C); Error) return;
+                    if (Error = TextFile.Field("Long",  L); Error) return;
+
+                    assert(V == Value);
+                    assert(N == Name);
+                    assert(W == std::wstring(Wide.begin(), Wide.end()));
+                    assert(C == "Literal");
+                    assert(L == (i == 0 ? Long : std::string{}));
+                }
+                else
+                {
+                    if (Error = TextFile.Field("Value", Value); Error) return;
+                    if (Error = TextFile.Field("Name",  Name); Error) return;
+                    if (Error = TextFile.Field("Wide",  Wide); Error) return;
+                    if (Error = TextFile.Field("Literal", "Literal"); Error) return;
+                    if (Error = TextFile.Field("Long",  i == 0 ? std::string_view{ Long } : std::string_view{}); Error) return;
+                }
+            }
+        );
+    }
+
+    //------------------------------------------------------------------------------
+    // Records added to a file that was already written (see Test02)
+    //------------------------------------------------------------------------------
+    inline
+    xerr AppendedRecords(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        if (Flags.m_isWriteAppend == false) return {};
+
+        // V3 is already in the file so it is not declared again, V2 is new
+        constexpr xtextfile::user_defined_types v3 { "V3", "fff" };
+        constexpr xtextfile::user_defined_types v2 { "V2", "ff" };
+
+        constexpr static std::array Types{ v3, v2 };
+        TextFile.AddUserTypes(Types);
+
+        constexpr int Times = 10;
+        if (auto Err = TextFile.Record("Appended"
+            , [&](std::size_t& C, xerr&)
+            {
+                if (isRead) assert(C == Times);
+                else        C = Times;
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                std::array Position = { static_cast<float>(i), 0.5f, 0.25f };
+
+                if (Error = TextFile.Field(v3.m_CRC, "Position", Position[0], Position[1], Position[2]); Error) return;
+                if (Error = TextFile.Field(v2.m_CRC, "UV", Position[1], Position[2]); Error) return;
+
+                if (isRead)
+                {
+                    assert(Position[0] == static_cast<float>(i));
+                    assert(Position[1] == 0.5f);
+                    assert(Position[2] == 0.25f);
+                }
+            }
+        ); Err) return Err;
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Jumping to records and rows using the .idx sidecar (only for text files)
+    //------------------------------------------------------------------------------
+    inline
+    xerr SeekRecords(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        // The sidecar (or the footer) gets saved when the file is closed so there is nothing to do while writing
+        if (isRead == false || Flags.m_isWriteIndex == false) return {};
+
+        constexpr int Times = 100;
+
+        //
+        // Start reading the RowFilter record from the middle (one is after an indexed row one is before)
+        // Binary files can only go to a row of records with fixed size fields (RowFilter has strings)
+        //
+        if (TextFile.isBinary())
+        {
+            if (auto Err = TextFile.SeekRecord("RowFilter", 10); !Err) return xerr::create_f<xtextfile::state, "Was able to seek a row of a binary record with strings">();
+        }
+
+        const auto Starts = TextFile.isBinary() ? std::vector<int>{ 0 } : std::vector<int>{ 75, 10 };
+        for (const int iStart : Starts)
+        {
+            std::int32_t Key;
+            int          nRows = 0;
+
+            if (auto Err = TextFile.SeekRecord("RowFilter", iStart); Err) return Err;
+
+            if (auto Err = TextFile.Record("RowFilter"
+                , [&](std::size_t& C, xerr&)
+                {
+                    assert(C == Times - iStart);
+                }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    if (Error = TextFile.Field("Key", Key); Error) return;
+                    assert(Key == static_cast<std::int32_t>(i + iStart));
+                    nRows++;
+                }
+            ); Err) return Err;
+
+            assert(nRows == Times - iStart);
+        }
+
+        // The user types come from the sidecar since we have not read their declarations yet
+        assert(TextFile.getUserTypeCount() > 0);
+
+        //
+        // Read just a range of rows from the end of a big record
+        //
+        for (const auto [iStart, nRows] : { std::pair{ 2900, 50 }, std::pair{ 2990, 50 } })
+        {
+            int nRead = 0;
+            if (auto Err = TextFile.SeekRecord("FixedRows", iStart, nRows); Err) return Err;
+
+            if (auto Err = TextFile.Record("FixedRows"
+                , [&](std::size_t& C, xerr&)
+                {
+                    assert(C == static_cast<std::size_t>(std::min(nRows, 3000 - iStart)));
+                }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    std::uint64_t Key;
+                    if (Error = TextFile.Field("Key", Key); Error) return;
+                    assert(Key == static_cast<std::uint64_t>(i + iStart) << 33);
+                    nRead++;
+                }
+            ); Err) return Err;
+
+            assert(nRead == std::min(nRows, 3000 - iStart));
+
+            // The rest of the rows are skipped so we are at the next record
+            assert(TextFile.getRecordName() == "ConstFields");
+        }
+
+        //
+        // Streamed records get their real count in the sidecar even when the file says [ Streamed : ? ]
+        //
+        const int iStreamed = TextFile.isBinary() ? 0 : 130;
+        if (auto Err = TextFile.SeekRecord("Streamed", iStreamed); Err) return Err;
+        assert(TextFile.getRecordCount() == 150 - iStreamed);
+        if (auto Err = TextFile.SeekRecord("Streamed", 150); !Err) return xerr::create_f<xtextfile::state, "Was able to seek past the end of the record">();
+
+        // Rows in the middle of a run of repeated values (^) still read their values
+        if (Flags.m_isWriteRepeats)
+        {
+            if (auto Err = TextFile.SeekRecord("RepeatedValues", 110); Err) return Err;
+            if (auto Err = RepeatedValues(TextFile, isRead, Flags, 110); Err) return Err;
+        }
+
+        // The sidecar also covers the records that were appended
+        if (Flags.m_isWriteAppend)
+        {
+            const int iAppended = TextFile.isBinary() ? 0 : 5;
+            if (auto Err = TextFile.SeekRecord("Appended", iAppended); Err) return Err;
+            assert(TextFile.getRecordCount() == 10 - iAppended);
+        }
+
+        //
+        // Go back to the first record so the rest of the tests can read the file in order
+        //
+        if (auto Err = TextFile.SeekRecord("TestTypes"); Err) return Err;
+        assert(TextFile.getRecordName() == "TestTypes");
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Every record of the tests in the order they are in the file
+    //------------------------------------------------------------------------------
+    inline
+    xerr AllRecords(xtextfile::stream& TextFile, const bool isRead, const xtextfile::flags Flags) noexcept
+    {
+        if (auto Err = SeekRecords(TextFile, isRead, Flags); Err)
+            return Err;
+
+        if (auto Err = AllTypes(TextFile, isRead, Flags); Err) 
+            return Err;
+
+        if (auto Err = SimpleVariableTypes(TextFile, isRead, Flags); Err) 
+            return Err;
+
+        if (auto Err = UserTypes(TextFile, isRead, Flags); Err ) 
+            return Err;
+      
+        if (auto Err = Properties(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = ColumnSelection(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = RowFilter(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = StreamedRecord(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = ConcurrentRecords(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = ParallelRecords(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = RepeatedValues(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = FloatPrecision(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = FixedRows(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = ConstFields(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        if (auto Err = AppendedRecords(TextFile, isRead, Flags); Err ) 
+            return Err;
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Test different types
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test01(std::wstring_view FileName, bool isRead, xtextfile::file_type FileType, xtextfile::flags Flags) noexcept
+    {
+        xtextfile::stream   TextFile;
+
+        //
+        // Before reading make sure the file is well formed
+        //
+        if (isRead)
+        {
+            if (auto Err = TextFile.Validate(FileName); Err)
+            {
+                std::cout << "Failed to validate " << Err.getMessage() << " Record: " << TextFile.getRecordName() << " Line: " << TextFile.getLineIndex() << "\n";
+                return Err;
+            }
+        }
+
+        //
+        // Open File
+        //
+        if (auto Err = TextFile.Open(isRead, FileName, FileType, Flags); Err)
+        {
+            std::cout << "Failed to open " << Err.getMessage() << "\n";
+            return Err;
+        }
+
+        //
+        // Run tests
+        // 
+        if (auto Err = AllRecords(TextFile, isRead, Flags); Err)
+            return Err;
+
+        //
+        // When we are reading and we are done dealing with records we can check if we are done reading a file like this
+        //
+        if (isRead && TextFile.isEOF())
+            return {};
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Adds records at the end of a file written by Test01
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test02(std::wstring_view FileName, xtextfile::file_type FileType, xtextfile::flags Flags) noexcept
+    {
+        xtextfile::stream   TextFile;
+
+        Flags.m_isWriteAppend = true;
+        if (auto Err = TextFile.Open(false, FileName, FileType, Flags); Err)
+        {
+            std::cout << "Failed to open for appending " << Err.getMessage() << "\n";
+            return Err;
+        }
+
+        return AppendedRecords(TextFile, false, Flags);
+    }
+
+    //------------------------------------------------------------------------------
+    // Writes a text and a binary file with a single pass of the callbacks
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test03(std::wstring_view TextFileName, std::wstring_view BinaryFileName, xtextfile::flags TextFlags) noexcept
+    {
+        xtextfile::stream   TextFile;
+        xtextfile::stream   BinaryFile;
+
+        if (auto Err = BinaryFile.Open(false, BinaryFileName, xtextfile::file_type::BINARY); Err)
+            return Err;
+
+        if (auto Err = TextFile.Open(false, TextFileName, xtextfile::file_type::TEXT, TextFlags); Err)
+            return Err;
+
+        TextFile.AddTeeOutput(BinaryFile);
+
+        return AllRecords(TextFile, false, TextFlags);
+    }
+
+    //------------------------------------------------------------------------------
+    // Writing the same contents again with m_isWriteIfChanged leaves the file (and its time) alone
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test04(std::wstring_view FileName, xtextfile::file_type FileType, xtextfile::flags Flags) noexcept
+    {
+        Flags.m_isWriteIfChanged = true;
+
+        auto Write = [&](bool isRead, bool bExtra) -> xerr
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(isRead, FileName, FileType, Flags); Err) return Err;
+            if (auto Err = AllTypes(File, isRead, Flags); Err) return Err;
+            if (auto Err = RepeatedValues(File, isRead, Flags); Err) return Err;
+            if (bExtra) return FloatPrecision(File, isRead, Flags);
+            return {};
+        };
+
+        const std::wstring IndexName = std::wstring(FileName) + L".idx";
+
+        // The temporary files have their own names, a file of the user called like them is left alone
+        const std::wstring UserName  = std::wstring(FileName) + L".tmp";
+        {
+            std::ofstream Out(std::filesystem::path(UserName), std::ios::binary);
+            Out << "Not ours";
+        }
+
+        auto isTempLeft = [&]
+        {
+            const auto Path = std::filesystem::path(FileName);
+            for (const auto& Entry : std::filesystem::directory_iterator(Path.parent_path()))
+            {
+                const auto Name = Entry.path().filename().wstring();
+                if (Entry.path() != std::filesystem::path(UserName) && Name.starts_with(Path.filename().wstring()) && Name.ends_with(L".tmp")) return true;
+            }
+            return std::filesystem::file_size(UserName) != 8;
+        };
+
+        if (auto Err = Write(false, false); Err) return Err;
+
+        // Move the time back so we can tell if the file gets touched
+        const auto OldTime = std::filesystem::last_write_time(FileName) - std::chrono::hours(1);
+        std::filesystem::last_write_time(FileName, OldTime);
+
+        // The .idx has the time of the file so it only stays the same from the second time on
+        for (int i = 0; i < 2; ++i)
+        {
+            if (Flags.m_isWriteIndex) std::filesystem::last_write_time(IndexName, OldTime);
+
+            if (auto Err = Write(false, false); Err) return Err;
+            assert(std::filesystem::last_write_time(FileName) == OldTime);
+            assert(i == 0 || Flags.m_isWriteIndex == false || std::filesystem::last_write_time(IndexName) == OldTime);
+            assert(isTempLeft() == false);
+        }
+
+        // New contents replace the file
+        if (auto Err = Write(false, true); Err) return Err;
+        assert(std::filesystem::last_write_time(FileName) != OldTime);
+        assert(isTempLeft() == false);
+
+        return Write(true, true);
+    }
+
+    //------------------------------------------------------------------------------
+    // Binary strings of any size and with nulls inside, plus reading a file of the first revision
+    // (strings with a terminator) which we build by hand since the writer does not make them anymore
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test05(std::wstring_view FileName, std::wstring_view OldFileName) noexcept
+    {
+        constexpr int Times = 100;
+
+        auto Strings = [&](bool isRead) -> xerr
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(isRead, FileName, xtextfile::file_type::BINARY); Err) return Err;
+
+            return File.Record("Strings"
+                , [&](std::size_t& C, xerr&)
+                {
+                    if (isRead) assert(C == Times);
+                    else        C = Times;
+                }
+                , [&](std::size_t iRow, xerr& Error)
+                {
+                    const int         i     = static_cast<int>(iRow);
+                    const std::string Value = std::string(static_cast<std::size_t>(i * 37), 'a' + i % 26) + std::string("\0end", 4);
+
+                    std::string  Name = Value;
+                    std::int32_t Id   = i;
+                    if (Error = File.Field("Name", Name); Error) return;
+                    if (Error = File.Field("Id", Id); Error) return;
+
+                    // A null string is written as an empty one
+                    std::string Empty;
+                    if (isRead)
+                    {
+                        if (Error = File.Field("Null", Empty); Error) return;
+                    }
+                    else
+                    {
+                        const char* pNull = nullptr;
+                        if (Error = File.Field("Null", pNull); Error) return;
+                    }
+
+                    if (isRead)
+                    {
+                        assert(Name == Value);
+                        assert(Id == i);
+                        assert(Empty.empty());
+                    }
+                });
+        };
+
+        if (auto Err = Strings(false); Err) return Err;
+        if (auto Err = Strings(true);  Err) return Err;
+
+        //
+        // Revision 0 file
+        //
+        {
+            std::ofstream Out(std::filesystem::path(OldFileName), std::ios::binary);
+
+            auto Put = [&](const auto& Value) { Out.write(reinterpret_cast<const char*>(&Value), sizeof(Value)); };
+
+            Put(std::uint32_t('NOIL'));
+            Out.write("[Legacy", 8);
+            Put(std::int32_t{ 3 });
+            Put(std::uint8_t{ 2 });
+            Out.write("Name:s", 7);
+            Out.write("Id:d", 5);
+            Out.write("abc", 4);  Put(std::int32_t{ 7 });
+            Out.write("", 1);     Put(std::int32_t{ 8 });
+            Out.write("last", 5); Put(std::int32_t{ 9 });
+        }
+
+        constexpr std::array<const char*, 3> Names = { "abc", "", "last" };
+
+        xtextfile::stream File;
+        if (auto Err = File.Open(true, OldFileName, xtextfile::file_type::BINARY); Err) return Err;
+
+        return File.Record("Legacy"
+            , [&](std::size_t& C, xerr&)
+            {
+                assert(C == Names.size());
+            }
+            , [&](std::size_t i, xerr& Error)
+            {
+                std::string  Name;
+                std::int32_t Id;
+                if (Error = File.Field("Name", Name); Error) return;
+                if (Error = File.Field("Id", Id); Error) return;
+
+                assert(Name == Names[i]);
+                assert(Id == static_cast<std::int32_t>(i) + 7);
+            });
+    }
+
+    //------------------------------------------------------------------------------
+    // Skipping records without decoding them (a file that Test01 wrote). The records that are
+    // read after skipping the ones before them still have the right values
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test06(std::wstring_view FileName, xtextfile::file_type FileType, xtextfile::flags Flags) noexcept
+    {
+        // Skip all the records
+        {
+            xtextfile::stream        File;
+            std::vector<std::string> Names;
+            if (auto Err = File.Open(true, FileName, FileType, Flags); Err) return Err;
+
+            while (File.isEOF() == false)
+            {
+                Names.emplace_back(File.getRecordName());
+                if (auto Err = File.SkipRecord(); Err) return Err;
+            }
+
+            assert(Names.front() == "TestTypes");
+            assert(Names.back()  == (Flags.m_isWriteAppend ? "Appended" : "ConstFields"));
+            assert(std::find(Names.begin(), Names.end(), "FixedRows") + 1 == std::find(Names.begin(), Names.end(), "ConstFields"));
+        }
+
+        // Skip up to FixedRows and read the rest (with a footer we go from record to record with it)
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(true, FileName, FileType, Flags); Err) return Err;
+            if (Flags.m_isWriteIndex) if (auto Err = File.SeekRecord("TestTypes"); Err) return Err;
+
+            while (File.getRecordName() != "FixedRows")
+            {
+                if (auto Err = File.SkipRecord(); Err) return Err;
+                assert(File.isEOF() == false);
+            }
+
+            if (auto Err = FixedRows(File, true, Flags); Err) return Err;
+            if (auto Err = ConstFields(File, true, Flags); Err) return Err;
+            if (auto Err = AppendedRecords(File, true, Flags); Err) return Err;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Appending to a binary file with a footer only reads the footer. The rows of the file are
+    // not even looked at, so here one of them is damaged on purpose after writing it
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test07(std::wstring_view FileName) noexcept
+    {
+        constexpr int              Times = 100;
+        constexpr xtextfile::flags Flags { .m_isWriteIndex = true, .m_isWriteAppend = true };
+
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(false, FileName, xtextfile::file_type::BINARY, { .m_isWriteIndex = true }); Err) return Err;
+
+            if (auto Err = File.Record("Names"
+                , [&](std::size_t& C, xerr&) { C = Times; }
+                , [&](std::size_t i, xerr& Error)
+                {
+                    std::string Name = std::format("Name{}", i);
+                    Error = File.Field("Name", Name);
+                }
+            ); Err) return Err;
+        }
+
+        // The length of the last name now goes past the end of the file
+        {
+            std::fstream Io(std::filesystem::path(FileName), std::ios::binary | std::ios::in | std::ios::out);
+            const std::string Bytes((std::istreambuf_iterator<char>(Io)), std::istreambuf_iterator<char>());
+            const auto        iLast = Bytes.rfind(std::format("Name{}", Times - 1));
+            assert(iLast != std::string::npos && Bytes[iLast - 1] == 6);
+
+            Io.seekp(static_cast<std::streamoff>(iLast - 1));
+            Io.put(0x7f);
+        }
+
+        {
+            xtextfile::stream Check;
+            assert(Check.Validate(FileName));
+        }
+
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(false, FileName, xtextfile::file_type::BINARY, Flags); Err) return Err;
+            if (auto Err = AppendedRecords(File, false, Flags); Err) return Err;
+        }
+
+        // The new footer has the records that were in the file and the new one
+        xtextfile::stream File;
+        if (auto Err = File.Open(true, FileName, xtextfile::file_type::BINARY, Flags); Err) return Err;
+
+        if (auto Err = File.SeekRecord("Appended"); Err) return Err;
+        if (auto Err = AppendedRecords(File, true, Flags); Err) return Err;
+
+        if (auto Err = File.SeekRecord("Names"); Err) return Err;
+        assert(File.getRecordCount() == Times);
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Files that Validate must reject. It also has to tell the record and the row where it
+    // found the problem
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test08(std::wstring_view TextFileName, std::wstring_view BinaryFileName) noexcept
+    {
+        auto isBadText = [&](const char* pText, std::string_view RecordName, int iLine)
+        {
+            {
+                std::ofstream Out(std::filesystem::path(TextFileName), std::ios::binary);
+                Out << pText;
+            }
+
+            xtextfile::stream Check;
+            assert(Check.Validate(TextFileName));
+            assert(Check.getRecordName() == RecordName);
+            assert(Check.getLineIndex() == iLine);
+        };
+
+        // A bad numeric value
+        isBadText( "[ First : 1 ]\n{ Id:d }\n  7\n\n"
+                   "[ Numbers : 3 ]\n{ Id:d  Value:f }\n  1  #3F800000\n  2  x12\n  3  #3F800000\n", "Numbers", 1 );
+
+        // A string without its closing quote
+        isBadText( "[ Strings : 2 ]\n{ Name:s }\n  \"abc\"\n  \"def\n", "Strings", 1 );
+
+        // A record with fewer rows than its count
+        isBadText( "[ Short : 3 ]\n{ Id:d }\n  1\n  2\n\n[ Next : 1 ]\n{ Id:d }\n  1\n", "Short", 2 );
+
+        // A record with more rows than its count, the extra one is found before the next record
+        isBadText( "[ Extra : 1 ]\n{ Id:d }\n  1\n  2\n\n[ Next : 1 ]\n{ Id:d }\n  1\n", "Extra", 1 );
+
+        //
+        // Binary files that were cut short. The rows of binary files are skipped so the
+        // row that was cut has to be found after the fact
+        //
+        constexpr int Times = 100;
+        constexpr int iCut  = 50;
+        for (const bool bFixedRows : { false, true })
+        {
+            {
+                xtextfile::stream File;
+                if (auto Err = File.Open(false, BinaryFileName, xtextfile::file_type::BINARY); Err) return Err;
+
+                if (auto Err = File.Record("First"
+                    , [&](std::size_t& C, xerr&) { C = 1; }
+                    , [&](std::size_t, xerr& Error)
+                    {
+                        std::int32_t Id = 7;
+                        Error = File.Field("Id", Id);
+                    }
+                ); Err) return Err;
+
+                if (auto Err = File.Record("Names"
+                    , [&](std::size_t& C, xerr&) { C = Times; }
+                    , [&](std::size_t i, xerr& Error)
+                    {
+                        if (bFixedRows)
+                        {
+                            std::int32_t Id = static_cast<std::int32_t>(i);
+                            Error = File.Field("Id", Id);
+                        }
+                        else
+                        {
+                            std::string Name = std::format("Name{}", i);
+                            Error = File.Field("Name", Name);
+                        }
+                    }
+                ); Err) return Err;
+            }
+
+            // Cut in the middle of the row iCut
+            const auto FileSize = std::filesystem::file_size(std::filesystem::path(BinaryFileName));
+            if (bFixedRows)
+            {
+                std::filesystem::resize_file(std::filesystem::path(BinaryFileName), FileSize - (Times - iCut) * sizeof(std::int32_t) + 2);
+            }
+            else
+            {
+                std::ifstream     In(std::filesystem::path(BinaryFileName), std::ios::binary);
+                const std::string Bytes((std::istreambuf_iterator<char>(In)), std::istreambuf_iterator<char>());
+                const auto        iRow = Bytes.find(std::format("Name{}", iCut));
+                assert(iRow != std::string::npos);
+                In.close();
+
+                std::filesystem::resize_file(std::filesystem::path(BinaryFileName), iRow + 2);
+            }
+
+            xtextfile::stream Check;
+            assert(Check.Validate(BinaryFileName));
+            assert(Check.getRecordName() == std::string_view("Names"));
+            assert(Check.getLineIndex() == iCut);
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Laying out the text blocks on worker threads writes the same bytes as doing it on the
+    // thread of the user. The records have many blocks of 64 lines, one of them streamed
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test09(std::wstring_view FileName, xtextfile::flags Flags) noexcept
+    {
+        auto Write = [&](std::wstring_view Name, xtextfile::flags Flags) -> xerr
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(false, Name, xtextfile::file_type::TEXT, Flags); Err) return Err;
+            if (auto Err = AllTypes(File, false, Flags); Err) return Err;
+            if (auto Err = SimpleVariableTypes(File, false, Flags); Err) return Err;
+            if (auto Err = UserTypes(File, false, Flags); Err) return Err;
+            if (auto Err = Properties(File, false, Flags); Err) return Err;
+            if (auto Err = StreamedRecord(File, false, Flags); Err) return Err;
+            if (auto Err = RepeatedValues(File, false, Flags); Err) return Err;
+            if (auto Err = FloatPrecision(File, false, Flags); Err) return Err;
+            return FixedRows(File, false, Flags);
+        };
+
+        auto Read = [](std::wstring_view Name)
+        {
+            std::ifstream In(std::filesystem::path(Name), std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(In)), std::istreambuf_iterator<char>());
+        };
+
+        const std::wstring ParallelName = std::wstring(FileName) + L".parallel";
+
+        Flags.m_isWriteParallel = false;
+        if (auto Err = Write(FileName, Flags); Err) return Err;
+
+        Flags.m_isWriteParallel = true;
+        if (auto Err = Write(ParallelName, Flags); Err) return Err;
+
+        assert(Read(FileName) == Read(ParallelName));
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Records with many blocks of rows are decoded by the worker threads. The rows still come
+    // in order, a reader can stop in the middle, and damaged blocks give an error
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test10(std::wstring_view FileName, xtextfile::flags Flags) noexcept
+    {
+        constexpr int Times = 20000;
+
+        auto Pool = [&](bool isRead, int& nRows, int iStop = 0) -> xerr
+        {
+            xtextfile::stream File;
+            if (auto Err = File.Open(isRead, FileName, xtextfile::file_type::BINARY, Flags); Err) return Err;
+
+            nRows = 0;
+            return File.Record("Pool"
+                , [&](std::size_t& C, xerr&)
+                {
+                    if (isRead) assert(C == Times);
+                    else        C = Times;
+                }
+                , [&](std::size_t iRow, xerr& Error)
+                {
+                    const int    i     = static_cast<int>(iRow);
+                    std::string  Name  = std::format("Row{}", i);
+                    std::int32_t Id    = i;
+                    double       Value = i * 0.5;
+
+                    if (Error = File.Field("Name", Name); Error) return;
+                    if (Error = File.Field("Id", Id); Error) return;
+                    if (Error = File.Field("Value", Value); Error) return;
+
+                    if (isRead)
+                    {
+                        assert(i == nRows);
+                        assert(Name == std::format("Row{}", i));
+                        assert(Id == i);
+                        assert(Value == i * 0.5);
+                    }
+
+                    // The rows that the workers decoded after this one are dropped
+                    if (++nRows == iStop) Error = xerr::create_f<xtextfile::state, "Stopped on purpose">();
+                });
+        };
+
+        auto ReadBytes = [&]
+        {
+            std::ifstream In(std::filesystem::path(FileName), std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(In)), std::istreambuf_iterator<char>());
+        };
+
+        auto WriteBytes = [&](const std::string& Bytes)
+        {
+            std::ofstream Out(std::filesystem::path(FileName), std::ios::binary);
+            Out.write(Bytes.data(), static_cast<std::streamsize>(Bytes.size()));
+        };
+
+        int nRows;
+        if (auto Err = Pool(false, nRows); Err) return Err;
+        if (auto Err = Pool(true, nRows); Err) return Err;
+        assert(nRows == Times);
+
+        assert(Pool(true, nRows, 1000));
+        assert(nRows == 1000);
+
+        const std::string Bytes = ReadBytes();
+
+        //
+        // Damaged blocks of rows near the end of the record. The rows before them are still fine
+        //
+        if (Flags.m_isWriteCompressed)
+        {
+            // Zeros where the compressed blocks are, their headers included
+            std::string Copy = Bytes;
+            std::fill_n(Copy.begin() + Copy.size() * 3 / 4, 4096, '\0');
+            WriteBytes(Copy);
+
+            assert(Pool(true, nRows));
+            assert(nRows < Times);
+
+            WriteBytes(Bytes);
+            return {};
+        }
+
+        // Each block starts with its header (Bytes nRows) and then the rows as they were written
+        auto Damage = [&](int iRow, int iByte, std::string_view Values)
+        {
+            std::string Copy  = Bytes;
+            const auto  iName = Copy.find(std::format("Row{}", iRow));
+            assert(iName != std::string::npos);
+
+            Copy.replace(iName + iByte, Values.size(), Values);
+            WriteBytes(Copy);
+
+            assert(Pool(true, nRows));
+            assert(nRows <= iRow);
+        };
+
+        // The last block (rows 19968 to 19999) says that it has no rows
+        Damage((Times - 1) / 64 * 64, -1 - 4, std::string_view("\0\0\0\0", 4));
+
+        // The length of a name goes past the end of its block
+        Damage(Times - 10, -1, "\x7f");
+
+        WriteBytes(Bytes);
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // The codec of the compressed blocks on its own: data that compresses well or not at all,
+    // matches that overlap and matches too far back, then compressed data that was damaged
+    //------------------------------------------------------------------------------
+    inline
+    xerr Test11(void) noexcept
+    {
+        std::uint32_t Seed   = 12345;
+        auto          Random = [&] { Seed = Seed * 1664525u + 1013904223u; return static_cast<char>(Seed >> 24); };
+
+        std::vector<std::string> Sources;
+        Sources.emplace_back();
+        Sources.emplace_back("a");
+        Sources.emplace_back("abcabc");
+        Sources.emplace_back(100000, 'x');
+        Sources.emplace_back(std::string(70000, ' '));
+        std::generate(Sources.back().begin(), Sources.back().end(), Random);
+
+        // The same 70000 bytes twice, too far back for a match
+        Sources.push_back(Sources.back() + Sources.back());
+
+        Sources.emplace_back();
+        for (int i = 0; i < 5000; ++i) Sources.back() += std::format("Row{} {} ", i, i * 0.5);
+
+        for (const auto& Src : Sources)
+        {
+            std::string Packed;
+            xtextfile::details::lz::Compress(Src, Packed);
+
+            std::string Unpacked(Src.size() + 1, '?');
+            assert(xtextfile::details::lz::Decompress(Packed, Unpacked.data(), Src.size()));
+            assert(std::string_view(Unpacked.data(), Src.size()) == Src);
+            assert(Unpacked.back() == '?');
+
+            // The size must be the right one
+            assert(xtextfile::details::lz::Decompress(Packed, Unpacked.data(), Src.size() + 1) == false);
+            if (Src.size()) assert(xtextfile::details::lz::Decompress(Packed, Unpacked.data(), Src.size() - 1) == false);
+
+            // Part of the data is not enough
+            for (std::size_t n = 0; n < Packed.size(); n += 1 + n / 8)
+                assert(xtextfile::details::lz::Decompress({ Packed.data(), n }, Unpacked.data(), Src.size()) == false);
+
+            // Damaged data does not go outside of the buffers (they are checked when built with a sanitizer)
+            for (std::size_t i = 0; i < Packed.size(); i += 1 + i / 8)
+            {
+                std::string Damaged = Packed;
+                Damaged[i] = Random();
+                xtextfile::details::lz::Decompress(Damaged, Unpacked.data(), Src.size());
+            }
+        }
+
+        // Data that repeats gets smaller
+        {
+            std::string Packed;
+            xtextfile::details::lz::Compress(Sources[3], Packed);
+            assert(Packed.size() < Sources[3].size() / 100);
+        }
+
+        // A match can not start before the data nor be at offset 0
+        {
+            char Out[8];
+            assert(xtextfile::details::lz::Decompress(std::string_view("\x10" "a" "\x02\x00" "\x00", 5), Out, 5) == false);
+            assert(xtextfile::details::lz::Decompress(std::string_view("\x10" "a" "\x00\x00" "\x00", 5), Out, 5) == false);
+            assert(xtextfile::details::lz::Decompress(std::string_view("\x10" "a" "\x01\x00" "\x00", 5), Out, 5));
+            assert(std::string_view(Out, 5) == "aaaaa");
+        }
+
+        return {};
+    }
+
+    //-----------------------------------------------------------------------------------------
+
+    void Test(void)
+    {
+        constexpr static auto FileName = L"./x64/TextFileTest.la";
+        xerr Error;
+        //
+        // Test write and read (Text Style)
+        //
+        if (true) if (0
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 1).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true }))
+            || (Error = Test02(std::format(L"{}{}.txt", FileName, 1).c_str(),        xtextfile::file_type::TEXT, { .m_isWriteIndex = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 1).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 2).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteFloats = true }))
+            || (Error = Test02(std::format(L"{}{}.txt", FileName, 2).c_str(),        xtextfile::file_type::TEXT, { .m_isWriteFloats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 2).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteFloats = true, .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 3).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteFloats = true, .m_isWriteIndex = true, .m_isWriteCompact = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 3).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteFloats = true, .m_isWriteIndex = true, .m_isWriteCompact = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 4).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteParallel = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 4).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteParallel = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 5).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteAlignRecord = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 5).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteAlignRecord = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 6).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteParallel = true, .m_isWriteAlignRecord = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 6).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteParallel = true, .m_isWriteAlignRecord = true }))
+            || (Error = Test03(std::format(L"{}{}.txt", FileName, 7).c_str(), std::format(L"{}{}.bin", FileName, 7).c_str(), { .m_isWriteIndex = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 7).c_str(), true,  xtextfile::file_type::TEXT,   { .m_isWriteIndex = true }))
+            || (Error = Test04(std::format(L"{}{}.txt", FileName, 11).c_str(), xtextfile::file_type::TEXT,   { .m_isWriteIndex = true }))
+            || (Error = Test04(std::format(L"{}{}.bin", FileName, 11).c_str(), xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 8).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 8).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 9).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteParallel = true, .m_isWriteAlignRecord = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 9).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteParallel = true, .m_isWriteAlignRecord = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 10).c_str(), false, xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteCompact = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.txt", FileName, 10).c_str(), true,  xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteCompact = true, .m_isWriteRepeats = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 7).c_str(), true,  xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test06(std::format(L"{}{}.txt", FileName, 1).c_str(),        xtextfile::file_type::TEXT, { .m_isWriteIndex = true, .m_isWriteAppend = true }))
+            || (Error = Test06(std::format(L"{}{}.txt", FileName, 9).c_str(),        xtextfile::file_type::TEXT, { .m_isWriteParallel = true, .m_isWriteAlignRecord = true, .m_isWriteRepeats = true }))
+            || (Error = Test09(std::format(L"{}{}.txt", FileName, 16).c_str(), { .m_isWriteIndex = true }))
+            || (Error = Test09(std::format(L"{}{}.txt", FileName, 17).c_str(), { .m_isWriteFloats = true, .m_isWriteAlignRecord = true }))
+            || (Error = Test09(std::format(L"{}{}.txt", FileName, 18).c_str(), { .m_isWriteRepeats = true }))
+            )
+        {
+            assert(false);
+        }
+
+        //
+        // Test write and read (Binary Style)
+        //
+        if (true) if (0
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 1).c_str(), false, xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test02(std::format(L"{}{}.bin", FileName, 1).c_str(),       xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 1).c_str(), true, xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 2).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteFloats = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 2).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteFloats = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 3).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true }))
+            || (Error = Test02(std::format(L"{}{}.bin", FileName, 3).c_str(),        xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 3).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test05(std::format(L"{}{}.bin", FileName, 4).c_str(), std::format(L"{}{}.bin", FileName, 5).c_str()))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 6).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteIndex = true }))
+            || (Error = Test02(std::format(L"{}{}.bin", FileName, 6).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteIndex = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 6).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteIndex = true, .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 8).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 8).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 1).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 3).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 6).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteIndex = true, .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 9).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteBlocks = true }))
+            || (Error = Test02(std::format(L"{}{}.bin", FileName, 9).c_str(),        xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 9).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 9).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 10).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true, .m_isWriteBlocks = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 10).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true, .m_isWriteBlocks = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 10).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteIndex = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 12).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteCompressed = true }))
+            || (Error = Test02(std::format(L"{}{}.bin", FileName, 12).c_str(),        xtextfile::file_type::BINARY, { xtextfile::flags{} }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 12).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 12).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteAppend = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 13).c_str(), false, xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true, .m_isWriteCompressed = true }))
+            || (Error = Test01(std::format(L"{}{}.bin", FileName, 13).c_str(), true,  xtextfile::file_type::BINARY, { .m_isWriteEndianSwap = true, .m_isWriteIndex = true, .m_isWriteCompressed = true }))
+            || (Error = Test06(std::format(L"{}{}.bin", FileName, 13).c_str(),        xtextfile::file_type::BINARY, { .m_isWriteIndex = true }))
+            || (Error = Test07(std::format(L"{}{}.bin", FileName, 14).c_str()))
+            || (Error = Test08(std::format(L"{}{}.txt", FileName, 15).c_str(), std::format(L"{}{}.bin", FileName, 15).c_str()))
+            || (Error = Test10(std::format(L"{}{}.bin", FileName, 16).c_str(), { .m_isWriteBlocks = true }))
+            || (Error = Test10(std::format(L"{}{}.bin", FileName, 17).c_str(), { .m_isWriteEndianSwap = true, .m_isWriteBlocks = true }))
+            || (Error = Test10(std::format(L"{}{}.bin", FileName, 18).c_str(), { .m_isWriteCompressed = true }))
+            || (Error = Test10(std::format(L"{}{}.bin", FileName, 19).c_str(), { .m_isWriteEndianSwap = true, .m_isWriteCompressed = true }))
+            || (Error = Test11())
+            )
+        {
+            assert(false);
+        }
+
+        // The same records take less room once their blocks are compressed
+        assert( std::filesystem::file_size( std::format(L"{}{}.bin", FileName, 12) ) < std::filesystem::file_size( std::format(L"{}{}.bin", FileName, 9) ) );
     }
 }
 
@@ -53,6 +53,35 @@ namespace xtextfile
             || std::is_same_v< double, T >
             || std::is_same_v< std::string, T >
             || std::is_same_v< std::wstring, T >;
+
+        // Types that can only be written since there is nothing to read them into
+        template< typename T >
+        constexpr static bool is_valid_write_type_v = is_valid_type_v<T>
+            || std::is_same_v< std::string_view, T >
+            || std::is_same_v< std::u16string_view, T >
+            || std::is_same_v< const char*, T >
+            || std::is_same_v< char*, T >
+            || (std::is_array_v<T> && std::is_same_v< char, std::remove_extent_t<T> >);
+
+        //------------------------------------------------------------------------------------------------
+        // Points the argument list at a value that is only going to be read by WriteColumn
+        template< typename T >
+        constexpr arglist::types toWriteArg( const T& Value ) noexcept
+        {
+                    if constexpr ( std::is_array_v<T> || std::is_same_v<T, char*> ) return static_cast<const char*>(Value);
+            else    if constexpr ( std::is_same_v<T, const char*> )                 return Value;
+            else                                                                    return const_cast<T*>(&Value);
+        }
+
+        //------------------------------------------------------------------------------------------------
+        // Owned copy of a value for a row_block
+        template< typename T >
+        auto toRowValue( const T& Value ) noexcept
+        {
+                    if constexpr ( std::is_same_v<T, std::u16string_view> )         return std::wstring( Value.begin(), Value.end() );
+            else    if constexpr ( is_valid_type_v<T> )                             return Value;
+            else                                                                    return std::string( Value );
+        }
     }
 
     //------------------------------------------------------------------------------------------------
@@ -83,14 +112,40 @@ namespace xtextfile
 
     //------------------------------------------------------------------------------------------------
 
+    template< std::size_t N, typename... T_ARGS > inline
+    void row_block::Field( crc32 UserType, const char(&pFieldName)[N], const T_ARGS&... Args) noexcept
+    {
+        static_assert((details::is_valid_write_type_v<T_ARGS> && ...));
+        m_Fields.push_back( field{ UserType, pFieldName, static_cast<int>(m_Values.size()), static_cast<int>(sizeof...(T_ARGS)) } );
+        ( m_Values.emplace_back( std::in_place_type<decltype(details::toRowValue(Args))>, details::toRowValue(Args) ), ... );
+    }
+
+    //------------------------------------------------------------------------------------------------
+
+    template< std::size_t N, typename... T_ARGS > inline
+    void row_block::Field( const char(&pFieldName)[N], const T_ARGS&... Args) noexcept
+    {
+        Field( crc32{ 0 }, pFieldName, Args... );
+    }
+
+    //------------------------------------------------------------------------------------------------
+
     template< std::size_t N, typename... T_ARGS > inline
     xerr stream::Field( crc32 UserType, const char(&pFieldName)[N], T_ARGS&... Args) noexcept
     {
-        static_assert((details::is_valid_type_v<T_ARGS> || ...));
-        details::arglist::out Out{ &Args... };
-        return isReading()
-            ? ReadColumn (UserType, pFieldName, Out)
-            : WriteColumn(UserType, pFieldName, Out);
+        // A non-const std::string_view and friends still go to the write only version
+        if constexpr ( ((details::is_valid_write_type_v<T_ARGS> && details::is_valid_type_v<T_ARGS> == false) || ...) )
+        {
+            return Field( UserType, pFieldName, std::as_const(Args)... );
+        }
+        else
+        {
+            static_assert((details::is_valid_type_v<T_ARGS> || ...));
+            details::arglist::out Out{ &Args... };
+            return isReading()
+                ? ReadColumn (UserType, pFieldName, Out)
+                : WriteColumn(UserType, pFieldName, Out);
+        }
     }
 
     //------------------------------------------------------------------------------------------------
@@ -102,6 +157,29 @@ namespace xtextfile
         return Field(UserType, pFieldName, Args...);
     }
 
+    //------------------------------------------------------------------------------------------------
+    // Const values can only be written. They are copied into the staging memory as the line is
+    // laid out so the caller does not need to keep them around (or make copies of its own).
+    //------------------------------------------------------------------------------------------------
+    template< std::size_t N, typename... T_ARGS > inline
+    xerr stream::Field( crc32 UserType, const char(&pFieldName)[N], const T_ARGS&... Args) noexcept
+    {
+        static_assert((details::is_valid_write_type_v<T_ARGS> && ...));
+        if (isReading())
+            return xerr::create< state::READ_TYPES_DONTMATCH, "Can not read into a const value or a view" >();
+
+        details::arglist::types Out[] = { details::toWriteArg(Args)... };
+        return WriteColumn(UserType, pFieldName, Out);
+    }
+
+    //------------------------------------------------------------------------------------------------
+
+    template< std::size_t N, typename... T_ARGS > inline
+    xerr stream::Field(const char(&pFieldName)[N], const T_ARGS&... Args) noexcept
+    {
+        return Field(crc32{ 0 }, pFieldName, Args...);
+    }
+
     //------------------------------------------------------------------------------------------------
 
     template< std::size_t N, typename TT, typename T > inline
@@ -179,6 +257,122 @@ namespace xtextfile
         return {};
     }
 
+    //------------------------------------------------------------------------------------------------
+    // When reading, the Predicate is called right after each line is read and before the Callback.
+    // It can read the fields it needs to decide (usually a key) and returns false to skip the line.
+    // Text fields are only decoded when read so the fields of the skipped lines are never decoded.
+    // When writing it is the same as a regular Record and the Predicate is not used.
+    //------------------------------------------------------------------------------------------------
+    template< std::size_t N, typename TT, typename TP, typename T > inline
+    xerr stream::RecordFilter( const char(&Str)[N], TT&& RecordStar, TP&& Predicate, T&& Callback) noexcept
+    {
+        if (m_File.m_States.m_isReading == false)
+            return Record(Str, std::forward<TT>(RecordStar), std::forward<T>(Callback));
+
+        if (std::strcmp(getRecordName().data(), Str) != 0)
+        {
+            return xerr::create< xtextfile::state::UNEXPECTED_RECORD, "Unexpected record" >();
+        }
+
+        xerr        Error;
+        std::size_t Count = getRecordCount();
+        RecordStar(Count, Error);
+        if (Error) return Error;
+
+        m_bDeferDecode = true;
+        for (std::remove_const_t<decltype(Count)> i = 0; i < Count; i++)
+        {
+            if (Error = ReadLine(); Error) break;
+
+            bool bKeep;
+            if constexpr (details::arg_count_v<TP> == 2)
+            {
+                bKeep = Predicate(i, Error);
+            }
+            else
+            {
+                static_assert(details::arg_count_v<TP> == 1);
+                bKeep = Predicate(Error);
+            }
+            if (Error) break;
+            if (bKeep == false) continue;
+
+            if constexpr (details::arg_count_v<T> == 2)
+            {
+                Callback(i, Error);
+            }
+            else
+            {
+                static_assert(details::arg_count_v<T> == 1);
+                Callback(Error);
+            }
+            if (Error) break;
+        }
+        m_bDeferDecode = false;
+
+        if (Error) return Error;
+
+        // Read the next record
+        if (Error = ReadRecord(); Error)
+        {
+            if (Error.getState<state>() == state::UNEXPECTED_EOF)
+            {
+                Error.clear();
+            }
+            else
+            {
+                return Error;
+            }
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------------------------
+    // When writing, the number of lines does not need to be known up front. HasMore is called before
+    // each line and returns false once the producer has nothing else to write. If the count is not
+    // known by the time the header goes out, text files write [ Name : ? ] and binary files patch it.
+    // When reading it is the same as a regular Record and HasMore is not used.
+    //------------------------------------------------------------------------------------------------
+    template< std::size_t N, typename TM, typename T > inline
+    xerr stream::RecordStream( const char(&Str)[N], TM&& HasMore, T&& Callback) noexcept
+    {
+        if (m_File.m_States.m_isReading)
+            return Record(Str, [](std::size_t&, xerr&) constexpr noexcept {}, std::forward<T>(Callback));
+
+        xerr Error;
+        bool bMore = HasMore(Error);
+        if (Error) return Error;
+
+        // Nothing to write, same as a record with zero lines
+        if (bMore == false) return {};
+
+        if (Error = WriteRecord(Str, m_UnknownCount); Error)
+            return Error;
+
+        for (std::size_t i = 0; bMore; i++)
+        {
+            if constexpr (details::arg_count_v<T> == 2)
+            {
+                Callback(i, Error);
+            }
+            else
+            {
+                static_assert(details::arg_count_v<T> == 1);
+                Callback(Error);
+            }
+            if (Error) return Error;
+
+            bMore = HasMore(Error);
+            if (Error) return Error;
+
+            if (Error = WriteStreamLine(bMore == false); Error)
+                return Error;
+        }
+
+        return {};
+    }
+
     //------------------------------------------------------------------------------------------------
 
     template< std::size_t N, typename T > inline
@@ -212,6 +406,18 @@ namespace xtextfile
     }
 
 
+    //------------------------------------------------------------------------------------------------
+    // Starts a record whose rows come from several threads as row_blocks (see SubmitRows). By default
+    // the blocks are written in the order of their first row so they must cover all the rows with no
+    // gaps. With bArrivalOrder they are written as they come, which is handy for logs. A Count of 0
+    // means it is not known, see RecordStream.
+    //------------------------------------------------------------------------------------------------
+    template< std::size_t N > inline
+    xerr stream::BeginConcurrentRecord( const char(&Str)[N], std::size_t Count, bool bArrivalOrder ) noexcept
+    {
+        return OpenConcurrentRecord( Str, Count, bArrivalOrder );
+    }
+
     //------------------------------------------------------------------------------------------------
 
     template< std::size_t N > inline
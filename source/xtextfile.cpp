@@ -3,6 +3,17 @@
 #include <cstdarg>
 #include <filesystem>
 #include <variant>
+#include <algorithm>
+#include <charconv>
+#include <bit>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <cmath>
+#include <atomic>
+#include <chrono>
 
 //-----------------------------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------------------------
@@ -91,6 +102,364 @@ namespace xtextfile
             std::memcpy(&result, &temp, sizeof(double));
             return result;
         }
+
+        // Swaps Count values that are Stride bytes apart. The values do not need to be aligned.
+        template< typename T >
+        static void SwapArray( char* pData, std::size_t Count, std::size_t Stride ) noexcept
+        {
+            for( std::size_t i=0; i<Count; ++i, pData += Stride )
+            {
+                T X;
+                std::memcpy( &X, pData, sizeof(T) );
+                X = Convert(X);
+                std::memcpy( pData, &X, sizeof(T) );
+            }
+        }
+
+        static void SwapArray( char* pData, std::size_t Count, int Size, std::size_t Stride ) noexcept
+        {
+            switch( Size )
+            {
+                case 2: SwapArray<std::uint16_t>( pData, Count, Stride ); break;
+                case 4: SwapArray<std::uint32_t>( pData, Count, Stride ); break;
+                case 8: SwapArray<std::uint64_t>( pData, Count, Stride ); break;
+            }
+        }
+
+        // Swaps Count values of Size bytes that are next to each other. With a stride known at
+        // compile time the compiler turns these loops into vector byte shuffles.
+        static void SwapBlock( char* pData, std::size_t Count, int Size ) noexcept
+        {
+            switch( Size )
+            {
+                case 2: SwapArray<std::uint16_t>( pData, Count, 2 ); break;
+                case 4: SwapArray<std::uint32_t>( pData, Count, 4 ); break;
+                case 8: SwapArray<std::uint64_t>( pData, Count, 8 ); break;
+            }
+        }
+
+        static int Convert( int value ) noexcept
+        {
+            return static_cast<int>( Convert( static_cast<std::uint32_t>(value) ) );
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------
+    // Binary files start with a signature that tells their revision and their endian. Revision 1
+    // writes the strings with their length in front (see file::ReadVarint) rather than a terminator.
+    //-----------------------------------------------------------------------------------------------------
+    namespace signature
+    {
+        constexpr std::uint32_t s_Revision0 = std::uint32_t('NOIL');
+        constexpr std::uint32_t s_Revision1 = std::uint32_t('NOI1');
+        constexpr std::uint32_t s_Revision2 = std::uint32_t('NOI2');
+        constexpr std::uint32_t s_Revision3 = std::uint32_t('NOI3');
+
+        // Returns false when it is not the signature of a binary file
+        static bool Decode( std::uint32_t Signature, details::states& States ) noexcept
+        {
+            for( auto Revision : { s_Revision0, s_Revision1, s_Revision2, s_Revision3 } )
+            {
+                if( Signature != Revision && Signature != endian::Convert(Revision) ) 
+                    continue;
+
+                States.m_isEndianSwap   = Signature != Revision;
+                States.m_isStringLength = Revision != s_Revision0;
+                States.m_isBlocks       = Revision == s_Revision2 || Revision == s_Revision3;
+                States.m_isCompressed   = Revision == s_Revision3;
+                return true;
+            }
+            return false;
+        }
+
+        // Every new file has at least the strings of revision 1, so readers that only know revision 0 can not
+        // read them. Revisions 2 and 3 are only used when their features are, so readers of revision 1 still can
+        static std::uint32_t Encode( details::states States ) noexcept
+        {
+            const std::uint32_t Revision = States.m_isCompressed ? s_Revision3 : States.m_isBlocks ? s_Revision2 : s_Revision1;
+            return States.m_isEndianSwap ? endian::Convert(Revision) : Revision;
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------
+    // Writes Value the way file::ReadVarint reads it and returns how many bytes it took (5 at most)
+    static int WriteVarint( char* pDest, std::uint32_t Value ) noexcept
+    {
+        int n = 0;
+        while( Value >= 0x80 )
+        {
+            pDest[n++] = static_cast<char>( (Value & 0x7f) | 0x80 );
+            Value >>= 7;
+        }
+        pDest[n++] = static_cast<char>(Value);
+        return n;
+    }
+
+    //-----------------------------------------------------------------------------------------------------
+    // Compression of the blocks of binary rows (revision 3). It is a byte oriented LZ77 where each
+    // sequence is some literals followed by a copy of what was already decompressed:
+    //
+    //      Token:u8 (literals:4 | match-4:4) [more literals] Literals [Offset:u16 [more match]]
+    //
+    //      A 15 in the token means that the length goes on in the bytes that follow (255 means
+    //      that one more byte follows). The last sequence has only literals.
+    //-----------------------------------------------------------------------------------------------------
+    namespace details::lz
+    {
+        constexpr int           s_MinMatch  = 4;
+        constexpr int           s_HashBits  = 12;
+        constexpr std::size_t   s_MaxOffset = 0xffff;
+
+        static std::uint32_t Load32( const char* p ) noexcept
+        {
+            std::uint32_t V;
+            std::memcpy( &V, p, 4 );
+            return V;
+        }
+
+        // Replaces Dst with Src compressed
+        void Compress( std::string_view Src, std::string& Dst ) noexcept
+        {
+            // Worst case is all literals
+            Dst.resize( Src.size() + Src.size() / 255 + 16 );
+
+            std::array<int, 1 << s_HashBits> Table;
+            Table.fill( -1 );
+
+            const char* const   pStart  = Src.data();
+            const char* const   pEnd    = pStart + Src.size();
+            const char*         pIn     = pStart;
+            const char*         pAnchor = pStart;
+            char*               pOut    = Dst.data();
+
+            auto Hash = []( std::uint32_t V ) noexcept
+            {
+                return ( V * 2654435761u ) >> ( 32 - s_HashBits );
+            };
+
+            auto WriteLength = [&]( std::size_t Length ) noexcept
+            {
+                for( ; Length >= 255; Length -= 255 ) *pOut++ = static_cast<char>(255);
+                *pOut++ = static_cast<char>(Length);
+            };
+
+            auto WriteSequence = [&]( std::size_t Offset, std::size_t MatchLength ) noexcept
+            {
+                const std::size_t nLiterals = static_cast<std::size_t>( pIn - pAnchor );
+                const std::size_t MatchCode = MatchLength ? MatchLength - s_MinMatch : 0;
+
+                *pOut++ = static_cast<char>( (std::min<std::size_t>( nLiterals, 15 ) << 4) | std::min<std::size_t>( MatchCode, 15 ) );
+                if( nLiterals >= 15 ) WriteLength( nLiterals - 15 );
+
+                std::memcpy( pOut, pAnchor, nLiterals );
+                pOut += nLiterals;
+
+                if( MatchLength )
+                {
+                    *pOut++ = static_cast<char>( Offset & 0xff );
+                    *pOut++ = static_cast<char>( Offset >> 8 );
+                    if( MatchCode >= 15 ) WriteLength( MatchCode - 15 );
+                }
+            };
+
+            // Data that does not compress gets looked at less and less often
+            int nMisses = 0;
+            while( pEnd - pIn >= s_MinMatch )
+            {
+                const std::uint32_t V     = Load32( pIn );
+                int&                Slot  = Table[ Hash(V) ];
+                const int           iPrev = Slot;
+                Slot = static_cast<int>( pIn - pStart );
+
+                if( iPrev < 0 || static_cast<std::size_t>( Slot - iPrev ) > s_MaxOffset || Load32( pStart + iPrev ) != V )
+                {
+                    pIn += 1 + (nMisses++ >> 6);
+                    continue;
+                }
+                nMisses = 0;
+
+                const char* pMatch   = pStart + iPrev;
+                const char* pMatched = pIn + s_MinMatch;
+                while( pMatched < pEnd && *pMatched == pMatch[ pMatched - pIn ] ) ++pMatched;
+
+                WriteSequence( static_cast<std::size_t>( pIn - pMatch ), static_cast<std::size_t>( pMatched - pIn ) );
+                pIn = pAnchor = pMatched;
+            }
+
+            pIn = pEnd;
+            WriteSequence( 0, 0 );
+            Dst.resize( static_cast<std::size_t>( pOut - Dst.data() ) );
+        }
+
+        // Returns false when Src is not valid or does not have exactly DstSize bytes
+        bool Decompress( std::string_view Src, char* pDst, std::size_t DstSize ) noexcept
+        {
+            auto              pIn   = reinterpret_cast<const std::uint8_t*>( Src.data() );
+            const auto        pEnd  = pIn + Src.size();
+            char*             pOut  = pDst;
+            char* const       pLast = pDst + DstSize;
+
+            auto ReadLength = [&]( std::size_t& Length ) noexcept
+            {
+                std::uint8_t B;
+                do
+                {
+                    if( pIn == pEnd ) return false;
+                    B = *pIn++;
+                    Length += B;
+                } while( B == 255 );
+                return true;
+            };
+
+            while( pIn != pEnd )
+            {
+                const std::uint8_t Token = *pIn++;
+
+                std::size_t nLiterals = Token >> 4;
+                if( nLiterals == 15 && ReadLength( nLiterals ) == false ) return false;
+                if( nLiterals > static_cast<std::size_t>( pEnd - pIn ) || nLiterals > static_cast<std::size_t>( pLast - pOut ) ) return false;
+
+                std::memcpy( pOut, pIn, nLiterals );
+                pOut += nLiterals;
+                pIn  += nLiterals;
+
+                // The last sequence has no match
+                if( pIn == pEnd ) return pOut == pLast;
+                if( pEnd - pIn < 2 ) return false;
+
+                const std::size_t Offset = pIn[0] | ( static_cast<std::size_t>(pIn[1]) << 8 );
+                pIn += 2;
+
+                std::size_t MatchLength = Token & 15;
+                if( MatchLength == 15 && ReadLength( MatchLength ) == false ) return false;
+                MatchLength += s_MinMatch;
+
+                if( Offset == 0 || Offset > static_cast<std::size_t>( pOut - pDst ) || MatchLength > static_cast<std::size_t>( pLast - pOut ) ) return false;
+
+                // The match may overlap with what it writes (ex: a run of the same byte)
+                const char* pMatch = pOut - Offset;
+                if( Offset >= MatchLength ) std::memcpy( pOut, pMatch, MatchLength );
+                else                        for( std::size_t i=0; i<MatchLength; ++i ) pOut[i] = pMatch[i];
+                pOut += MatchLength;
+            }
+
+            return false;
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------
+    // Locale free number formatting for the text writer. All of them write a null terminated
+    // string and return its length (without the null).
+    //-----------------------------------------------------------------------------------------------------
+    namespace format
+    {
+        constexpr static char s_HexDigits[] = "0123456789ABCDEF";
+
+        constexpr static auto s_DecimalPairs = []() constexpr
+        {
+            std::array<char, 200> Table{};
+            for( int i=0; i<100; ++i )
+            {
+                Table[i*2 + 0] = static_cast<char>('0' + i / 10);
+                Table[i*2 + 1] = static_cast<char>('0' + i % 10);
+            }
+            return Table;
+        }();
+
+        constexpr static std::uint64_t s_Pow10[] = 
+        { 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull
+        , 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull
+        , 1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull
+        , 10000000000000000000ull 
+        };
+
+        //-----------------------------------------------------------------------------------------------------
+        // Writes the bits of a value as '#' followed by upper case hex digits
+        static int Hex( char* pDest, std::uint64_t Value ) noexcept
+        {
+            const int nDigits = Value ? (static_cast<int>(std::bit_width(Value)) + 3) / 4 : 1;
+
+            pDest[0]           = '#';
+            pDest[nDigits + 1] = 0;
+            for( int i = nDigits; i; --i, Value >>= 4 )
+                pDest[i] = s_HexDigits[Value & 0xf];
+
+            return nDigits + 1;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        // Writes a decimal integer, two digits at a time from the back
+        static int Unsigned( char* pDest, std::uint64_t Value ) noexcept
+        {
+            int nDigits = 1;
+            while( nDigits < 20 && Value >= s_Pow10[nDigits - 1] ) nDigits++;
+
+            char* p = pDest + nDigits;
+            *p = 0;
+            while( Value >= 100 )
+            {
+                const auto i = static_cast<int>(Value % 100) * 2;
+                Value /= 100;
+                p    -= 2;
+                p[0]  = s_DecimalPairs[i + 0];
+                p[1]  = s_DecimalPairs[i + 1];
+            }
+
+            if( Value >= 10 )
+            {
+                const auto i = static_cast<int>(Value) * 2;
+                p[-2] = s_DecimalPairs[i + 0];
+                p[-1] = s_DecimalPairs[i + 1];
+            }
+            else
+            {
+                p[-1] = static_cast<char>('0' + Value);
+            }
+
+            return nDigits;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+
+        static int Signed( char* pDest, std::int64_t Value ) noexcept
+        {
+            if( Value < 0 )
+            {
+                pDest[0] = '-';
+                return 1 + Unsigned( pDest + 1, 0ull - static_cast<std::uint64_t>(Value) );
+            }
+
+            return Unsigned( pDest, static_cast<std::uint64_t>(Value) );
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        // The reader takes numeric tokens of up to 255 characters, floats never get close to that
+        constexpr std::size_t s_MaxFloatChars = 128;
+
+        //-----------------------------------------------------------------------------------------------------
+        // Writes the shortest string that reads back to the exact same value, unless the column asked
+        // for a precision: Format 'f' is Digits after the '.' and 'g' is Digits significant digits.
+        // Big values with 'f' that do not fit in s_MaxFloatChars (ex: 1e300) use the shortest form.
+        // IntWidth returns how many characters come before the '.' (all of them when there is none)
+        template< typename T >
+        static int Float( char* pDest, std::size_t DestSize, T Value, int& IntWidth, char Format = 0, int Digits = 0 ) noexcept
+        {
+            char* const pEnd = pDest + std::min( DestSize - 1, s_MaxFloatChars );
+
+            auto R = Format == 'f' ? std::to_chars( pDest, pEnd, Value, std::chars_format::fixed,   Digits )
+                   : Format == 'g' ? std::to_chars( pDest, pEnd, Value, std::chars_format::general, Digits )
+                   :                 std::to_chars( pDest, pEnd, Value );
+            if( R.ec != std::errc{} ) 
+                R = std::to_chars( pDest, pEnd, Value );
+
+            assert( R.ec == std::errc{} );
+            *R.ptr = 0;
+
+            const int Length = static_cast<int>(R.ptr - pDest);
+            for( IntWidth = 0; IntWidth < Length && pDest[IntWidth] != '.'; IntWidth++ );
+
+            return Length;
+        }
     }
 }
 
@@ -121,43 +490,39 @@ namespace xtextfile::details
     }
 
     //-----------------------------------------------------------------------------------------------------
-
-    inline std::string wstring_to_ascii_escape(std::wstring_view str)
+    // Writes the string straight into pDest with the non-printable characters as \uXXXX escapes.
+    // pDest must have room for 6 bytes per character. Returns the number of bytes written.
+    //-----------------------------------------------------------------------------------------------------
+    template< typename T_CHAR >
+    int wstring_to_ascii_escape( char* pDest, std::basic_string_view<T_CHAR> str ) noexcept
     {
-        if (str.empty())
-            return {};
-
-        static_assert(sizeof(wchar_t) >= 2, "wchar_t must be at least 16 bits");
-
-        // Worst case: all characters are non-ASCII to \uXXXX = 6 bytes
-        std::string result;
-        result.reserve(str.size() * 6);
+        static_assert(sizeof(T_CHAR) >= 2, "wide characters must be at least 16 bits");
 
-        for (wchar_t ch : str)
+        char* p = pDest;
+        for (T_CHAR ch : str)
         {
             if (ch >= 0x20 && ch <= 0x7E && ch != '\\') // printable ASCII, skip encoding
             {
-                result.push_back(static_cast<char>(ch));
+                *p++ = static_cast<char>(ch);
             }
             else if (ch == '\\') // escape backslash
             {
-                result += "\\\\";
+                *p++ = '\\';
+                *p++ = '\\';
             }
             else
             {
-                result += "\\u";
+                *p++ = '\\';
+                *p++ = 'u';
                 for (int shift = 12; shift >= 0; shift -= 4)
                 {
-                    unsigned digit = (ch >> shift) & 0xF;
-                    result.push_back(digit < 10 ? ('0' + digit) : ('A' + (digit - 10)));
+                    unsigned digit = (static_cast<unsigned>(ch) >> shift) & 0xF;
+                    *p++ = static_cast<char>(digit < 10 ? ('0' + digit) : ('A' + (digit - 10)));
                 }
             }
         }
 
-        // Safety assertions
-        assert(!result.empty());
-
-        return result;
+        return static_cast<int>(p - pDest);
     }
 
     //------------------------------------------------------------------------------
@@ -264,6 +629,7 @@ namespace xtextfile::details
         }
     #endif
 
+        m_States             = {};
         m_States.m_isBinary  = isBinary;
         m_States.m_isReading = true;
         m_States.m_isView    = false;
@@ -272,11 +638,17 @@ namespace xtextfile::details
 
     //------------------------------------------------------------------------------
 
-    xerr file::openForWriting( const std::wstring_view FilePath, bool isBinary  ) noexcept
+    xerr file::openForWriting( const std::wstring_view FilePath, bool isBinary, bool bAppend, bool bNew ) noexcept
     {
         assert(m_pFP == nullptr);
+        assert(bAppend == false || bNew == false);
     #if defined(_MSC_VER)
-        auto Err = _wfopen_s(&m_pFP, std::wstring(FilePath).c_str(), isBinary ? L"wb" : L"wt" );
+        // Appending uses r+ rather than a since binary files patch things that were already written
+        // and x makes the open fail when the file is already there
+        const wchar_t* pMode = bAppend ? (isBinary ? L"r+b" : L"r+t") 
+                             : bNew    ? (isBinary ? L"wbx" : L"wtx") 
+                             :           (isBinary ? L"wb"  : L"wt");
+        auto Err = _wfopen_s(&m_pFP, std::wstring(FilePath).c_str(), pMode );
         if (Err != 0)
         {
             xerr::LogMessage<state::FAILURE>(strXstr(std::format(L"Error while using _wfopen_s with {} Gave, Error code reported: {}", FilePath, Err)));
@@ -297,10 +669,14 @@ namespace xtextfile::details
         }
     #endif
 
+        m_States             = {};
         m_States.m_isBinary  = isBinary;
         m_States.m_isReading = false;
         m_States.m_isView    = false;
 
+        if( bAppend && fseek( m_pFP, 0, SEEK_END ) )
+            return xerr::create_f< state, "Fail to move to the end of the file to append to it" >();
+
         return {};
     }
 
@@ -316,7 +692,7 @@ namespace xtextfile::details
 
     xerr file::ReadingErrorCheck( void ) noexcept
     {
-        if( m_States.m_isEOF || feof( m_pFP ) ) 
+        if( m_States.m_isEOF || m_pInput || feof( m_pFP ) ) 
         {
             m_States.m_isEOF = true;
             return xerr::create<state::UNEXPECTED_EOF, "Found the end of the file unexpectedly while reading" >();
@@ -328,9 +704,20 @@ namespace xtextfile::details
     template< typename T >
     xerr file::Read( T& Buffer, int Size, int Count ) noexcept
     {
-        assert(m_pFP);
         if( m_States.m_isEOF ) return ReadingErrorCheck();
 
+        if( m_pInput )
+        {
+            const auto Bytes = static_cast<std::size_t>(Size) * Count;
+            if( Bytes > m_InputSize - m_iInput ) return ReadingErrorCheck();
+
+            std::memcpy( &Buffer, &m_pInput[m_iInput], Bytes );
+            m_iInput += Bytes;
+            return {};
+        }
+
+        assert(m_pFP);
+
     #if defined(_MSC_VER)
         if ( Count != fread_s( &Buffer, Size, Size, Count, m_pFP ) )
             return ReadingErrorCheck();
@@ -343,19 +730,62 @@ namespace xtextfile::details
 
     xerr file::getC( int& c ) noexcept
     {
-        assert(m_pFP);
         if( m_States.m_isEOF ) return ReadingErrorCheck();
 
+        if( m_pInput )
+        {
+            if( m_iInput == m_InputSize ) return ReadingErrorCheck();
+            c = static_cast<std::uint8_t>( m_pInput[m_iInput++] );
+            return {};
+        }
+
+        assert(m_pFP);
+
         c = fgetc(m_pFP);
         if( c == -1 ) return ReadingErrorCheck();
         return {};
     }
 
+    //------------------------------------------------------------------------------
+    // Gives back the character that getC just read, so the next getC reads it again
+    //------------------------------------------------------------------------------
+    void file::UngetC( int c ) noexcept
+    {
+        assert(m_pFP);
+        ungetc( c, m_pFP );
+    }
+
+    //------------------------------------------------------------------------------
+    // 7 bits per byte starting with the lowest ones, the high bit says that more bytes follow
+    //------------------------------------------------------------------------------
+    xerr file::ReadVarint( std::uint32_t& Value ) noexcept
+    {
+        Value = 0;
+        for( int Shift = 0; Shift < 35; Shift += 7 )
+        {
+            int c;
+            if( auto Err = getC(c); Err )
+                return Err;
+
+            Value |= static_cast<std::uint32_t>(c & 0x7f) << Shift;
+            if( (c & 0x80) == 0 ) 
+                return {};
+        }
+
+        return xerr::create_f< state, "Found a length that is not valid" >();
+    }
+
     //------------------------------------------------------------------------------
 
     template< typename T >
     xerr file::Write( T& Buffer, int Size, int Count ) noexcept
     {
+        if( m_pOutput )
+        {
+            m_pOutput->append( reinterpret_cast<const char*>(&Buffer), static_cast<std::size_t>(Size) * Count );
+            return {};
+        }
+
         assert(m_pFP);
 
     #if defined(_MSC_VER)
@@ -370,15 +800,71 @@ namespace xtextfile::details
 
     //------------------------------------------------------------------------------
 
-    int file::Tell() noexcept
+    std::int64_t file::Tell() noexcept
     {
+        if( m_pOutput ) return static_cast<std::int64_t>(m_pOutput->size());
+        if( m_pInput  ) return static_cast<std::int64_t>(m_iInput);
+
+    #if defined(_MSC_VER)
+        return _ftelli64( m_pFP );
+    #else
         return ftell( m_pFP );
+    #endif
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr file::Skip( int Count ) noexcept
+    {
+        if( Count == 0 ) return {};
+        if( m_States.m_isEOF ) return ReadingErrorCheck();
+
+        if( m_pInput )
+        {
+            if( static_cast<std::size_t>(Count) > m_InputSize - m_iInput ) return ReadingErrorCheck();
+            m_iInput += Count;
+            return {};
+        }
+
+        assert(m_pFP);
+
+        if( fseek( m_pFP, Count, SEEK_CUR ) )
+            return xerr::create_f< state, "Fail to skip data while reading the file" >();
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr file::SeekSet( std::int64_t Offset ) noexcept
+    {
+        assert(m_pFP);
+
+        // The offset is in the file, not in the buffer
+        m_pInput = nullptr;
+
+    #if defined(_MSC_VER)
+        if( _fseeki64( m_pFP, Offset, SEEK_SET ) )
+    #else
+        if( fseek( m_pFP, static_cast<long>(Offset), SEEK_SET ) )
+    #endif
+            return xerr::create_f< state, "Fail to move to the requested position of the file" >();
+
+        // We may have been at the end of the file before
+        m_States.m_isEOF = false;
+        return {};
     }
 
     //------------------------------------------------------------------------------
 
     xerr file::WriteStr( const std::string_view Buffer ) noexcept
     {
+        if( m_pOutput )
+        {
+            m_pOutput->append( Buffer );
+            return {};
+        }
+
         assert(m_pFP);
         // assert(Buffer.empty() || Buffer[Buffer.size() - 1] == 0);
 
@@ -408,6 +894,28 @@ namespace xtextfile::details
     {
         va_list Args;
         va_start( Args, pFmt );
+
+        if( m_pOutput )
+        {
+            va_list Copy;
+            va_copy( Copy, Args );
+            const int Length = std::vsnprintf( nullptr, 0, pFmt, Copy );
+            va_end( Copy );
+
+            if( Length < 0 )
+            {
+                va_end( Args );
+                return xerr::create_f< state, "Fail 'vsnprintf' writing the required data" >();
+            }
+
+            const auto Offset = m_pOutput->size();
+            m_pOutput->resize( Offset + Length + 1 );
+            std::vsnprintf( m_pOutput->data() + Offset, Length + 1, pFmt, Args );
+            m_pOutput->pop_back();
+            va_end( Args );
+            return {};
+        }
+
         if( std::vfprintf( m_pFP, pFmt, Args ) < 0 )
             return xerr::create_f< state, "Fail 'fprintf' writing the required data" >();
         va_end( Args );
@@ -418,6 +926,12 @@ namespace xtextfile::details
 
     xerr file::WriteChar( char C, int Count ) noexcept
     {
+        if( m_pOutput )
+        {
+            m_pOutput->append( static_cast<std::size_t>(Count), C );
+            return {};
+        }
+
         while( Count-- )
         {
             if( C != fputc( C, m_pFP ) )
@@ -432,6 +946,12 @@ namespace xtextfile::details
     {
         assert( m_States.m_isBinary );
 
+        if( m_pOutput )
+        {
+            m_pOutput->append( Buffer );
+            return {};
+        }
+
         if( Buffer.size() != std::fwrite( Buffer.data(), 1, Buffer.size(), m_pFP ) )
             return xerr::create_f< state, "Fail 'fwrite' binary mode" >();
 
@@ -485,7 +1005,7 @@ namespace xtextfile::details
 
     xerr file::HandleDynamicTable( int& Count ) noexcept
     {
-        auto        LastPosition    = ftell( m_pFP );
+        const auto  LastPosition    = Tell();
         int         c;
                 
         Count           = -2;                   // -1. for the current header line, -1 for the types
@@ -504,9 +1024,14 @@ namespace xtextfile::details
             {
                 Count++;
                 if( auto Err = ReadWhiteSpace(c); Err ) 
+                {
+                    // The table was the last thing in the file
+                    if( Err.getState<state>() == state::UNEXPECTED_EOF ) break;
                     return Err;
+                }
             
-                if( c == '[' )
+                // Any record, label or block of user types ends the table
+                if( c == '[' || c == '@' || c == '<' )
                 {
                     break;
                 }
@@ -514,13 +1039,14 @@ namespace xtextfile::details
             else
             {
                 if( auto Err = getC(c); Err ) 
-                    return Err;
-            
-                // if the end of the file is in a line then we need to count it
-                if( c == -1 )
                 {
-                    Count++;
-                    break;
+                    // if the end of the file is in a line then we need to count it
+                    if( Err.getState<state>() == state::UNEXPECTED_EOF )
+                    {
+                        Count++;
+                        break;
+                    }
+                    return Err;
                 }
             }
     
@@ -531,25 +1057,141 @@ namespace xtextfile::details
             return xerr::create_f< state, "Unexpected end of file while counting rows for the dynamic table" >();
     
         // Rewind to the start
-        if( fseek( m_pFP, LastPosition, SEEK_SET ) )
-            return xerr::create_f< state, "Fail to reposition the cursor back to the right place while reading the file" >();
+        if( auto Err = SeekSet( LastPosition ); Err )
+            return xerr::create_f< state, "Fail to reposition the cursor back to the right place while reading the file" >(Err);
 
         return {};
     }
-}
 
-//-----------------------------------------------------------------------------------------------------
-//-----------------------------------------------------------------------------------------------------
-// Class functions
-//-----------------------------------------------------------------------------------------------------
-//-----------------------------------------------------------------------------------------------------
-namespace xtextfile
-{
-    //------------------------------------------------------------------------------------------------
-    // Some static variables
-    //------------------------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------------------------
+    // The user types of the stream that runs RecordsParallel. The jobs add their new ones here so each
+    // type gets one index for all of them, the stream writes them before the output of the next job.
+    //-----------------------------------------------------------------------------------------------------
+    struct shared_user_types
+    {
+        stream&                                     m_Owner;
+        std::mutex                                  m_Mutex     {};
+    };
 
-    //------------------------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------------------------
+    // Worker threads that lay out blocks of text lines into memory while the user keeps writing.
+    // Each job has its own stream (in memory mode) with a copy of the block, the stream that owns
+    // the pipeline writes the finished jobs to the file in the order they were submitted.
+    //-----------------------------------------------------------------------------------------------------
+    struct text_pipeline
+    {
+        struct job
+        {
+            stream                                  m_Formatter {};
+            std::string                             m_Output    {};
+            xerr                                    m_Error     {};
+            bool                                    m_bDone     {};
+        };
+
+        ~text_pipeline( void ) noexcept
+        {
+            {
+                std::scoped_lock Lock( m_Mutex );
+                m_bQuit = true;
+            }
+            m_WorkReady.notify_all();
+
+            for( auto& Worker : m_Workers )
+                Worker.join();
+        }
+
+        std::vector<std::thread>                    m_Workers   {};
+        std::mutex                                  m_Mutex     {};
+        std::condition_variable                     m_WorkReady {};
+        std::condition_variable                     m_JobDone   {};
+        std::deque<job*>                            m_Pending   {};     // Jobs waiting for a worker
+        std::deque<std::unique_ptr<job>>            m_InFlight  {};     // Jobs in the order they must go to the file
+        std::vector<std::unique_ptr<job>>           m_FreeJobs  {};
+        bool                                        m_bQuit     {};
+    };
+
+    //-----------------------------------------------------------------------------------------------------
+    // Blocks of binary rows (revision 2) that a worker decodes. The job has its own stream that reads
+    // the blocks from m_Input, and the rows end up one after the other in m_Memory with the fields of
+    // every column pointing into it, ready for stream::ReadDecodedRow to hand out.
+    //-----------------------------------------------------------------------------------------------------
+    struct decode_job
+    {
+        stream                                      m_Decoder       {};
+        std::vector<char>                           m_Input         {};     // The rows of the blocks (without their headers)
+        std::vector<char>                           m_Packed        {};     // Compressed files, the blocks as they are in the file
+        std::vector<std::pair<int,int>>             m_Blocks        {};     // Compressed files, the size of each block in m_Packed and once decompressed
+        int                                         m_nRows         {};
+        std::vector<char>                           m_Memory        {};
+        std::vector<field_info>                     m_Fields        {};     // m_FieldInfo of each column of each row
+        std::vector<int>                            m_ColumnEnds    {};     // Where the fields of each column of each row end in m_Fields
+        std::vector<field_type>                     m_Dynamic       {};     // m_DynamicFields of the columns with dynamic types, one per row
+        xerr                                        m_Error         {};
+        bool                                        m_bDone         {};
+    };
+
+    //-----------------------------------------------------------------------------------------------------
+    // Worker threads that decode the blocks of binary records while the user reads the rows. The jobs
+    // are handed out in the order they were read from the file, m_pCurrent is the one being read.
+    //-----------------------------------------------------------------------------------------------------
+    struct block_pipeline
+    {
+        ~block_pipeline( void ) noexcept
+        {
+            {
+                std::scoped_lock Lock( m_Mutex );
+                m_bQuit = true;
+            }
+            m_WorkReady.notify_all();
+
+            for( auto& Worker : m_Workers )
+                Worker.join();
+        }
+
+        std::vector<std::thread>                    m_Workers   {};
+        std::mutex                                  m_Mutex     {};
+        std::condition_variable                     m_WorkReady {};
+        std::condition_variable                     m_JobDone   {};
+        std::deque<decode_job*>                     m_Pending   {};     // Jobs waiting for a worker
+        std::deque<std::unique_ptr<decode_job>>     m_InFlight  {};     // Jobs in the order of the file
+        std::vector<std::unique_ptr<decode_job>>    m_FreeJobs  {};
+        std::unique_ptr<decode_job>                 m_pCurrent  {};
+        int                                         m_iRow      {};     // Next row of m_pCurrent
+        int                                         m_iField    {};
+        int                                         m_iDynamic  {};
+        bool                                        m_bQuit     {};
+    };
+
+    //-----------------------------------------------------------------------------------------------------
+    // State of a record that gets its rows from several threads. The producers fill their row_blocks
+    // on their own, the lock is only taken to write a block into the stream.
+    //-----------------------------------------------------------------------------------------------------
+    struct concurrent_record
+    {
+        std::mutex                                  m_Mutex         {};
+        std::map<std::size_t, row_block>            m_Pending       {};     // Blocks waiting for the ones before them
+        row_block                                   m_Held          {};     // When the count is not known the last block waits for the end
+        bool                                        m_bHeld         {};
+        bool                                        m_bArrivalOrder {};
+        bool                                        m_bKnownCount   {};
+        std::size_t                                 m_iNextRow      {};     // First row of the next block in order
+        xerr                                        m_Error         {};     // First error, EndConcurrentRecord returns it as well
+        std::vector<arglist::types>                 m_Args          {};
+    };
+}
+
+//-----------------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------------
+// Class functions
+//-----------------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------------
+namespace xtextfile
+{
+    //------------------------------------------------------------------------------------------------
+    // Some static variables
+    //------------------------------------------------------------------------------------------------
+
+    //------------------------------------------------------------------------------------------------
     bool stream::isValidType( int Type ) const noexcept
     {
         switch( Type )
@@ -575,6 +1217,11 @@ namespace xtextfile
 
     xerr stream::openForReading( const std::wstring_view FilePath ) noexcept
     {
+        // Remember the file so we can find its .idx sidecar
+        m_FilePath = FilePath;
+        m_Index.clear();
+        m_NextRecordOffset = 0;
+
         //
         // Check to see if we can get a hint from the file name to determine if it is binary or text
         //
@@ -621,10 +1268,9 @@ namespace xtextfile
             else 
             {
                 Error.clear();
-                if( Signature == std::uint32_t('NOIL') || Signature == std::uint32_t('LION') )
+                if( signature::Decode( Signature, m_File.m_States ) )
                 {
-                    if( Signature == std::uint32_t('LION') )
-                        m_File.m_States.m_isEndianSwap = true;
+                    // A binary file, the signature told us how to read it
                 }
                 else // We are dealing with a text file, if so the reopen it as such
                 {
@@ -657,26 +1303,94 @@ namespace xtextfile
     xerr stream::openForWriting( const std::wstring_view FilePath, file_type FileType, flags Flags ) noexcept
     {
         //
-        // Open the file
+        // When appending we need to know what the file already has (an empty or missing file is just a new file)
+        //
+        std::error_code Ec;
+        const auto      ExistingSize = std::filesystem::file_size( FilePath, Ec );
+        const bool      bAppend      = Flags.m_isWriteAppend && !Ec && ExistingSize > 0;
+
+        stream Existing;
+        if( bAppend )
+        {
+            if( auto Err = Existing.LoadForAppend( FilePath, FileType ); Err )
+                return Err;
+        }
+
+        // Remember the file so we can save its .idx sidecar
+        m_FilePath = FilePath;
+        m_Index.clear();
+
+        m_TempPath.clear();
+
+        // The new records go where the footer of the binary file was (a new one is written on close)
+        if( bAppend && Existing.m_Index.m_FooterOffset )
+        {
+            std::filesystem::resize_file( FilePath, static_cast<std::uintmax_t>(Existing.m_Index.m_FooterOffset), Ec );
+            if( Ec ) return xerr::create_f< state, "Fail to remove the footer of the file to append to" >();
+        }
+
+        //
+        // Open the file. With m_isWriteIfChanged it is a new temporary file next to it which is never one
+        // that was already there, so other files and other writers of the same file are left alone.
+        // Appending changes the file anyway so it is written in place.
         //
-        if( auto Err = m_File.openForWriting( FilePath, FileType == file_type::BINARY ); Err ) 
+        if( Flags.m_isWriteIfChanged && bAppend == false )
+        {
+            static const std::uint64_t          s_Seed  = std::hash<std::thread::id>{}( std::this_thread::get_id() ) 
+                                                        ^ static_cast<std::uint64_t>( std::chrono::system_clock::now().time_since_epoch().count() );
+            static std::atomic<std::uint64_t>   s_Count {};
+
+            for( int iTry = 0; ; ++iTry )
+            {
+                m_TempPath = std::format( L"{}.{:016x}.tmp", m_FilePath, s_Seed + 0x9E3779B97F4A7C15ull * s_Count++ );
+
+                auto Err = m_File.openForWriting( m_TempPath, FileType == file_type::BINARY, false, true );
+                if( !Err ) break;
+
+                if( iTry == 8 || std::filesystem::exists( m_TempPath, Ec ) == false )
+                {
+                    m_TempPath.clear();
+                    return Err;
+                }
+                Err.clear();
+            }
+        }
+        else if( auto Err = m_File.openForWriting( FilePath, FileType == file_type::BINARY, bAppend ); Err ) 
+        {
             return Err;
+        }
 
         //
         // Okay make sure that we say that we are not reading the file
         // this will force the user_types to stick with the writing functions
         //
         xerr                Error;
-        xerr::cleanup CleanU(Error, [&] { close(); });
+        xerr::cleanup CleanU(Error, [&] 
+        {
+            // A file that failed to open does not replace anything
+            if( m_TempPath.empty() == false )
+            {
+                m_File.close();
+
+                std::error_code RemoveEc;
+                std::filesystem::remove( m_TempPath, RemoveEc );
+                m_TempPath.clear();
+            }
+            close(); 
+        });
 
 
         //
         // Determine whether we are binary or text base
         //
-        if( FileType == file_type::BINARY )
+        if( FileType == file_type::BINARY && bAppend == false )
         {
             // Write binary signature
-            const std::uint32_t Signature = std::uint32_t('NOIL');
+            details::states States;
+            States.m_isEndianSwap = Flags.m_isWriteEndianSwap;
+            States.m_isBlocks     = Flags.m_isWriteBlocks || Flags.m_isWriteCompressed;
+            States.m_isCompressed = Flags.m_isWriteCompressed;
+            const std::uint32_t Signature = signature::Encode( States );
             if( Error = m_File.Write( Signature ); Error )
                 return Error;
         }
@@ -684,8 +1398,57 @@ namespace xtextfile
         //
         // Handle flags
         //
-        m_File.m_States.m_isEndianSwap = Flags.m_isWriteEndianSwap;
+        // Appending keeps the endian and the revision of the file
+        const bool bBinaryAppend = bAppend && FileType == file_type::BINARY;
+        m_File.m_States.m_isEndianSwap   = bBinaryAppend ? Existing.m_File.m_States.m_isEndianSwap   : Flags.m_isWriteEndianSwap;
+        m_File.m_States.m_isStringLength = bBinaryAppend ? Existing.m_File.m_States.m_isStringLength : FileType == file_type::BINARY;
+        m_File.m_States.m_isBlocks       = bBinaryAppend ? Existing.m_File.m_States.m_isBlocks       : FileType == file_type::BINARY && (Flags.m_isWriteBlocks || Flags.m_isWriteCompressed);
+        m_File.m_States.m_isCompressed   = bBinaryAppend ? Existing.m_File.m_States.m_isCompressed   : FileType == file_type::BINARY && Flags.m_isWriteCompressed;
         m_File.m_States.m_isSaveFloats = Flags.m_isWriteFloats;
+        m_File.m_States.m_isWriteIndex   = Flags.m_isWriteIndex;
+        m_File.m_States.m_isWriteCompact = Flags.m_isWriteCompact && FileType == file_type::TEXT;
+        m_File.m_States.m_isWriteRepeats = Flags.m_isWriteRepeats && FileType == file_type::TEXT;
+
+        // Compact lines are written one at a time so there is nothing to lay out in parallel
+        if( Flags.m_isWriteParallel && FileType == file_type::TEXT && Flags.m_isWriteCompact == false )
+            StartTextPipeline();
+
+        //
+        // The user types of the file are not written again. Binary files refer to them by
+        // index so they must keep the order of the file, the ones the user added go after.
+        //
+        if( bAppend )
+        {
+            auto UserTypes = std::move( m_UserTypes );
+            m_UserTypes.clear();
+            m_UserTypeMap.clear();
+
+            for( auto& UserType : Existing.m_UserTypes )
+                m_UserTypes[ AddUserType( UserType ) ].m_bAlreadySaved = true;
+
+            for( auto& UserType : UserTypes )
+                AddUserType( UserType );
+
+            // The .idx sidecar covers the whole file
+            if( m_File.m_States.m_isWriteIndex )
+            {
+                m_Index           = std::move( Existing.m_Index );
+                m_Index.m_bLoaded = false;
+            }
+        }
+
+        // Compact lines have no alignment so only the aligned text needs the temporary file
+        if( Flags.m_isWriteAlignRecord && FileType == file_type::TEXT && Flags.m_isWriteCompact == false )
+        {
+            auto pSpill = std::tmpfile();
+            if( pSpill == nullptr )
+                return Error = xerr::create_f< state, "Fail to create the temporary file used to align the records" >();
+
+            details::states SpillStates;
+            SpillStates.m_isBinary = true;
+            m_Spill.setup( *pSpill, SpillStates );
+            m_File.m_States.m_isWriteAlignRecord = true;
+        }
 
         //
         // Initialize some of the Write variables
@@ -700,684 +1463,2731 @@ namespace xtextfile
 
     //-----------------------------------------------------------------------------------------------------
 
-    void stream::close( void ) noexcept
+    // Defined here since the pipeline is only known by this file
+    stream::stream( void ) noexcept = default;
+
+    //-----------------------------------------------------------------------------------------------------
+
+    stream::~stream( void ) noexcept
     {
-        m_File.close();
+        close();
     }
 
-    //------------------------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------------------------
 
-    xerr stream::Open( bool isRead, std::wstring_view View, file_type FileType, flags Flags ) noexcept
+    void stream::close( void ) noexcept
     {
-        if( isRead )
-        {
-            if( auto Err = openForReading( View ); Err ) return Err;
-        }
-        else
+        // The tee outputs are closed by their owner
+        m_TeeOutputs.clear();
+        m_pConcurrent.reset();
+
+        // Blocks that are still being laid out must reach the file first
+        if( m_pPipeline )
         {
-            if(auto Err = openForWriting( View, FileType, Flags ); Err ) return Err;
+            if( auto Err = FlushTextBlocks( 0 ); Err )
+            {
+                auto StringView = Err.getMessage();
+                printf("Fail to write the text blocks: %.*s\n", static_cast<int>(StringView.size()), StringView.data() );
+            }
+            m_pPipeline.reset();
         }
 
-        return {};
-    }
+        // The temporary file gets deleted by the system once it is closed
+        m_Spill.close();
 
-    //------------------------------------------------------------------------------
+        m_pDecoder.reset();
 
-    std::uint32_t stream::AddUserType( const user_defined_types& UserType ) noexcept
-    {
-        if( const auto It = m_UserTypeMap.find(UserType.m_CRC); It != m_UserTypeMap.end() )
+        const bool bSaveIndex = m_File.m_pFP && m_File.m_States.m_isWriteIndex && m_File.m_States.m_isBinary == false;
+        const bool bWasOpen   = m_File.m_pFP != nullptr;
+
+        // Binary files keep the index at their end
+        if( m_File.m_pFP && m_File.m_States.m_isWriteIndex && m_File.m_States.m_isBinary )
         {
-            const auto Index = It->second;
-            
-            // Make sure that this registered err is fully duplicated
-            assert( UserType.m_SystemTypes == m_UserTypes[Index].m_SystemTypes );
-        
-            // we already have it so we don't need to added again
-            return Index;
+            if( auto Err = WriteFooter(); Err )
+            {
+                auto StringView = Err.getMessage();
+                printf("Fail to write the footer: %.*s\n", static_cast<int>(StringView.size()), StringView.data() );
+            }
         }
 
-        //
-        // Sanity check the user_types types
-        //
-#ifdef _DEBUG
+        m_File.close();
+
+        // Only now we know if the contents changed
+        if( bWasOpen && m_TempPath.empty() == false )
         {
-            for( int i=0; UserType.m_Name[i]; i++ )
+            if( auto Err = ReplaceIfChanged(); Err )
             {
-                assert( false == std::isspace(UserType.m_Name[i]) );
+                auto StringView = Err.getMessage();
+                printf("Fail to replace the file: %.*s\n", static_cast<int>(StringView.size()), StringView.data() );
+
+                // The file stays as it was
+                std::error_code Ec;
+                std::filesystem::remove( m_TempPath, Ec );
             }
-    
-            for( int i=0; UserType.m_SystemTypes[i]; i++ )
+        }
+
+        // The sidecar keeps the size and time of the file so it can only be saved after closing it
+        if( bSaveIndex )
+        {
+            if( auto Err = SaveIndex(); Err )
             {
-                assert( false == std::isspace(UserType.m_SystemTypes[i]) );
+                auto StringView = Err.getMessage();
+                printf("Fail to save the index: %.*s\n", static_cast<int>(StringView.size()), StringView.data() );
             }
         }
-#endif
-        //
-        // Fill the entry
-        //
-        std::uint32_t Index  = static_cast<std::uint32_t>(m_UserTypes.size());
-        m_UserTypes.emplace_back(UserType);
 
-        m_UserTypeMap.insert( {UserType.m_CRC, Index} );
-
-        return Index;
+        m_TempPath.clear();
     }
 
-    //------------------------------------------------------------------------------
-    void stream::AddUserTypes( std::span<user_defined_types> UserTypes ) noexcept
+    //------------------------------------------------------------------------------------------------
+    // Description:
+    //      With m_isWriteIfChanged the new contents are in m_TempPath. If they are the same as the
+    //      ones of m_FilePath the temporary file goes away and the file is not touched (so its time
+    //      stays the same), otherwise the temporary file is renamed over it in one step.
+    //------------------------------------------------------------------------------------------------
+    xerr stream::ReplaceIfChanged( void ) noexcept
     {
-        for( auto& T : UserTypes )
-            AddUserType( T );
-    }
+        std::error_code Ec;
+        const auto      NewSize = std::filesystem::file_size( m_TempPath, Ec );
+        if( Ec ) return xerr::create_f< state, "Fail to get the size of the temporary file" >();
 
-    //------------------------------------------------------------------------------
-    void stream::AddUserTypes( std::span<const user_defined_types> UserTypes ) noexcept
-    {
-        for( auto& T : UserTypes )
-            AddUserType( T );
+        bool bChanged = std::filesystem::file_size( m_FilePath, Ec ) != NewSize || Ec;
+        if( bChanged == false )
+        {
+            details::file New, Old;
+            if( auto Err = New.openForReading( m_TempPath, true ); Err ) return Err;
+            if( auto Err = Old.openForReading( m_FilePath, true ); Err ) return Err;
+
+            // Compare a block at a time, stop at the first difference
+            constexpr std::size_t       BlockSize = 64 * 1024;
+            std::unique_ptr<char[]>     NewBlock{ new char[BlockSize] };
+            std::unique_ptr<char[]>     OldBlock{ new char[BlockSize] };
+            for( std::uintmax_t Left = NewSize; Left && bChanged == false; )
+            {
+                const auto Size = static_cast<std::size_t>( std::min<std::uintmax_t>( Left, BlockSize ) );
+                if( std::fread( NewBlock.get(), 1, Size, New.m_pFP ) != Size ) return xerr::create_f< state, "Fail to read the temporary file" >();
+                if( std::fread( OldBlock.get(), 1, Size, Old.m_pFP ) != Size ) return xerr::create_f< state, "Fail to read the file to compare it" >();
+
+                bChanged  = std::memcmp( NewBlock.get(), OldBlock.get(), Size ) != 0;
+                Left     -= Size;
+            }
+        }
+
+        if( bChanged )
+        {
+            std::filesystem::rename( m_TempPath, m_FilePath, Ec );
+            if( Ec ) return xerr::create_f< state, "Fail to replace the file with the temporary file" >();
+        }
+        else
+        {
+            std::filesystem::remove( m_TempPath, Ec );
+            if( Ec ) return xerr::create_f< state, "Fail to delete the temporary file" >();
+        }
+
+        return {};
     }
 
-    //------------------------------------------------------------------------------
+    //------------------------------------------------------------------------------------------------
 
-    xerr stream::WriteRecord( const char* pHeaderName, std::size_t Count ) noexcept
+    xerr stream::Open( bool isRead, std::wstring_view View, file_type FileType, flags Flags ) noexcept
     {
-        assert( pHeaderName );
-        assert( m_File.m_States.m_isReading == false );
-
-        //
-        // Fill the record info
-        //
-        strcpy_s( m_Record.m_Name.data(), m_Record.m_Name.size(), pHeaderName);
-        if( Count == ~0 ) 
-        { 
-            m_Record.m_bWriteCount  = false;  
-            m_Record.m_Count        = 1; 
-        }
-        else if (Count == (~0 - 1))
+        if( isRead )
         {
-            m_Record.m_bWriteCount  = false;
-            m_Record.m_Count        = 1;
-            m_iLine     = 0;
-            m_nColumns  = -1;
-            return WriteLine();
+            if( auto Err = openForReading( View ); Err ) return Err;
         }
         else
-        { 
-            m_Record.m_bWriteCount  = true; 
-            m_Record.m_Count        = static_cast<int>(Count); 
+        {
+            if(auto Err = openForWriting( View, FileType, Flags ); Err ) return Err;
         }
 
-        //
-        // Reset the line count
-        //
-        m_iLine         = 0;
-        m_iColumn       = 0;
-        m_iMemOffet     = 0;
-        m_nColumns      = 0;
-
         return {};
     }
 
     //------------------------------------------------------------------------------
-    static 
-    bool isCompatibleTypes( char X, details::arglist::types Y ) noexcept
+    // Description:
+    //      Walks the whole file checking its structure: user types, record headers, column types,
+    //      the row counts and every value (numeric syntax and string termination). Nothing gets
+    //      decoded for the user. When it fails, getRecordName and getLineIndex tell where.
+    //------------------------------------------------------------------------------
+    xerr stream::Validate( std::wstring_view FilePath ) noexcept
     {
-        return std::visit([&]( auto Value )
-        {
-            using t = std::decay_t<decltype(Value)>;
-                    if constexpr ( std::is_same_v<t,bool*>               ) return X == 'c';
-            else    if constexpr ( std::is_same_v<t,std::uint8_t*>       ) return X == 'h';
-            else    if constexpr ( std::is_same_v<t,std::uint16_t*>      ) return X == 'H';
-            else    if constexpr ( std::is_same_v<t,std::uint32_t*>      ) return X == 'g';
-            else    if constexpr ( std::is_same_v<t,std::uint64_t*>      ) return X == 'G';
-            else    if constexpr ( std::is_same_v<t,std::int8_t*>        ) return X == 'c';
-            else    if constexpr ( std::is_same_v<t,std::int16_t*>       ) return X == 'C';
-            else    if constexpr ( std::is_same_v<t,std::int32_t*>       ) return X == 'd';
-            else    if constexpr ( std::is_same_v<t,std::int64_t*>       ) return X == 'D';
-            else    if constexpr ( std::is_same_v<t,float*>              ) return X == 'f';
-            else    if constexpr ( std::is_same_v<t,double*>             ) return X == 'F';
-            else    if constexpr ( std::is_same_v<t,std::string*>        ) return X == 's';
-            else    if constexpr ( std::is_same_v<t,std::wstring*>       ) return X == 'S';
-            else    return false;
-        }, Y );
+        return WalkFile( FilePath, false );
     }
 
     //------------------------------------------------------------------------------
-
-    xerr stream::WriteComment( const std::string_view Comment ) noexcept
+    // Description:
+    //      Builds the .idx sidecar of an existing text file with a single validating pass.
+    //      Useful for files that were not written with flags::m_isWriteIndex.
+    //------------------------------------------------------------------------------
+    xerr stream::BuildIndex( std::wstring_view FilePath ) noexcept
     {
-        if( m_File.m_States.m_isReading )
-            return {};
+        if( auto Err = WalkFile( FilePath, true ); Err )
+            return Err;
 
         if( m_File.m_States.m_isBinary )
+            return xerr::create_f< state, "Binary files keep their index in a footer, write them with flags::m_isWriteIndex" >();
+
+        return SaveIndex();
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::WalkFile( std::wstring_view FilePath, bool bBuildIndex ) noexcept
+    {
+        m_bValidateOnly = true;
+
+        // Where it failed is left in m_Record and m_iLine for the caller (see Validate)
+        xerr Error;
+
+        if( Error = openForReading( FilePath ); Error )
         {
-            return {};
+            m_bValidateOnly = false;
+            return Error;
         }
-        else
+
+        // Binary data is skipped by seeking so the reads alone do not tell when the file is too short
+        std::error_code Ec;
+        const auto FileSize = static_cast<std::int64_t>( std::filesystem::file_size( FilePath, Ec ) );
+        if( Ec )
         {
-            const auto  length = Comment.length();
-            std::size_t iStart = 0;
-            std::size_t iEnd   = iStart;
+            m_bValidateOnly = false;
+            close();
+            return Error = xerr::create_f< state, "Unable to get the size of the file" >();
+        }
 
-            if( auto Err = m_File.WriteChar( '\n' ); Err )
-                return Err;
+        // The first record starts at the top of the file since ReadRecord skips comments and reads user types
+        std::int64_t RecordOffset = 0;
+        do
+        {
+            // Labels don't have any data
+            const int Count = m_Record.m_bLabel ? 0 : m_Record.m_Count;
 
-            do 
+            if( bBuildIndex )
+                AddIndexEntry( RecordOffset, m_Record.m_bLabel );
+
+            for( int i=0; i<Count; ++i )
             {
-                if( auto Err = m_File.WriteStr( "//" ); Err )
-                    return Err;
+                // Binary files only keep where the records start
+                if( bBuildIndex && i && (i % m_nIndexRowStep) == 0 && m_File.m_States.m_isBinary == false )
+                    m_Index.m_RowOffsets.push_back( m_File.Tell() );
 
-                while( iEnd < length)
+                if( Error = ReadLine(); Error )
+                    break;
+            }
+            if( Error )
+            {
+                if( m_File.m_States.m_isBinary && Error.getState<state>() == state::UNEXPECTED_EOF )
                 {
-                    if( Comment[iEnd] == '\n' ) { iEnd++; break; }
-                    else                          iEnd++;
+                    FindCutRow( FileSize );
+                    Error = xerr::create< state::UNEXPECTED_EOF, "The file is shorter than its records said" >();
                 }
+                break;
+            }
 
-                if( auto Err = m_File.WriteStr( { Comment.data() + iStart, static_cast<std::size_t>(iEnd - iStart) } ); Err )
-                    return Err;
-
-                if( iEnd == length) break;
+            RecordOffset = m_File.Tell();
+            if( Error = ReadRecord(); Error )
+            {
+                if( Error.getState<state>() == state::UNEXPECTED_EOF )
+                {
+                    // The rows of the last record may have been skipped past the end of the file
+                    if( m_File.Tell() > FileSize )
+                    {
+                        FindCutRow( FileSize );
+                        Error = xerr::create< state::UNEXPECTED_EOF, "The file is shorter than its records said" >();
+                    }
+                    else
+                    {
+                        Error.clear();
+                    }
+                }
+                break;
+            }
 
-                // Get ready for the next line
-                iStart = iEnd++;
+        } while( true );
 
-            } while( true );
-        }
+        m_bValidateOnly = false;
+        close();
 
-        return {};
+        return Error;
     }
 
     //------------------------------------------------------------------------------
-
-    xerr stream::WriteUserTypes( void ) noexcept
+    // Description:
+    //      Binary data is skipped by seeking and fixed size rows are read many at a time so a
+    //      file that was cut short is only noticed after the row that was cut. This reads the
+    //      current record again from its header and leaves in m_iLine the first row that is not whole.
+    //------------------------------------------------------------------------------
+    void stream::FindCutRow( std::int64_t FileSize ) noexcept
     {
-        if( m_File.m_States.m_isBinary )
+        m_iLine = 0;
+        if( m_File.SeekSet( m_Record.m_Offset ) || ReadRecord() || ReadTypes() )
+            return;
+
+        PlanFixedRows();
+        const int RowBytes = m_FixedRows.m_RowBytes;
+
+        int nRows = 0;
+        if( RowBytes && m_File.m_States.m_isBlocks )
         {
-            bool bHaveUserTypes = false;
-            for( auto& UserType : m_UserTypes )
+            // Only the headers of the blocks are read, a block that was not compressed may still have some whole rows
+            while( m_BlockCursor.m_nRows < m_Record.m_Count )
             {
-                if( UserType.m_bAlreadySaved )
-                    continue;
-            
-                UserType.m_bAlreadySaved = true;
-            
-                // First write the standard symbol for the user_types types
-                if( bHaveUserTypes == false )
+                nRows = m_BlockCursor.m_nRows;
+                if( ReadBlockHeader() ) 
+                    break;
+
+                if( m_BlockCursor.m_End > FileSize )
                 {
-                    bHaveUserTypes = true;
-                    if( auto Err = m_File.WriteChar( '<' ); Err )
-                        return Err;
+                    if( m_BlockCursor.m_Bytes == m_BlockCursor.m_RawBytes )
+                        nRows += static_cast<int>( (FileSize - m_File.Tell()) / RowBytes );
+                    break;
                 }
 
-                // Write the name 
-                if( auto Err = m_File.WriteStr( { UserType.m_Name.data(), static_cast<std::size_t>(UserType.m_NameLength + 1) } ); Err )
-                    return Err;
-
-                // Write type/s
-                if( auto Err = m_File.WriteStr( { UserType.m_SystemTypes.data(), static_cast<std::size_t>(UserType.m_nSystemTypes+1) } ); Err )
-                    return Err;
+                if( m_File.SeekSet( m_BlockCursor.m_End ) )
+                    break;
             }
         }
+        else if( RowBytes )
+        {
+            nRows = static_cast<int>( std::min<std::int64_t>( (FileSize - m_File.Tell()) / RowBytes, m_Record.m_Count ) );
+        }
         else
         {
-            //
-            // Dump all the new types if we have some
-            //
-            bool bNewTypes = false;
-            for( auto& UserType : m_UserTypes )
-            {
-                if( UserType.m_bAlreadySaved )
-                    continue;
+            // The file only goes past its end when ReadLine skips the data of a row
+            while( nRows < m_Record.m_Count && !ReadLine() && m_File.Tell() <= FileSize )
+                nRows++;
+        }
 
-                if( bNewTypes == false ) 
-                {
-                    if( auto Err = m_File.WriteStr( "\n// New Types\n< " ); Err ) 
-                        return Err;
+        m_iLine = nRows;
+    }
 
-                    bNewTypes = true;
-                }
+    //------------------------------------------------------------------------------
+    // Description:
+    //      The .idx sidecar is itself a binary xtextfile. It keeps the size and time of the
+    //      text file so a stale index is never used, the user types (a seek may skip their
+    //      declarations), where each record starts and where every m_nIndexRowStep-th row starts.
+    //------------------------------------------------------------------------------
+    xerr stream::SaveIndex( void ) noexcept
+    {
+        std::error_code Ec;
+        const auto FileSize = std::filesystem::file_size( m_FilePath, Ec );
+        if( Ec ) return xerr::create_f< state, "Fail to get the size of the file to index" >();
 
-                UserType.m_bAlreadySaved = true;
-                std::array<char,256> temp;
+        const auto FileTime = std::filesystem::last_write_time( m_FilePath, Ec );
+        if( Ec ) return xerr::create_f< state, "Fail to get the time of the file to index" >();
 
-                auto length = sprintf_s( temp.data(), temp.size(), "%s:%s ", UserType.m_Name.data(), UserType.m_SystemTypes.data());
-                if( auto Err = m_File.WriteStr( {temp.data(), static_cast<std::size_t>(length)} ); Err ) 
-                    return Err;
-            }
+        int             Version = m_IndexVersion;
+        int             RowStep = m_nIndexRowStep;
+        std::int64_t    Size    = static_cast<std::int64_t>(FileSize);
+        std::int64_t    Time    = static_cast<std::int64_t>(FileTime.time_since_epoch().count());
 
-            if( bNewTypes ) if( auto Err = m_File.WriteStr( ">\n" ); Err ) return Err;
-        }
+        // The sidecar of a file that was not touched does not change either
+        flags IndexFlags {};
+        IndexFlags.m_isWriteIfChanged = m_TempPath.empty() == false;
 
-        return {};
+        stream Index;
+        if( auto Err = Index.Open( false, m_FilePath + L".idx", file_type::BINARY, IndexFlags ); Err )
+            return Err;
+
+        xerr Error;
+        0
+        || (Error = Index.Record( "Index"
+            , [&]( xerr& Error )
+            {
+                0
+                || (Error = Index.Field( "Version", Version ))
+                || (Error = Index.Field( "RowStep", RowStep ))
+                || (Error = Index.Field( "FileSize", Size ))
+                || (Error = Index.Field( "FileTime", Time ))
+                ;
+            }))
+        || (Error = Index.Record( "UserTypes"
+            , [&]( std::size_t& C, xerr& )
+            {
+                C = m_UserTypes.size();
+            }
+            , [&]( std::size_t i, xerr& Error )
+            {
+                std::string Name  { m_UserTypes[i].m_Name.data() };
+                std::string Types { m_UserTypes[i].m_SystemTypes.data() };
+                0
+                || (Error = Index.Field( "Name", Name ))
+                || (Error = Index.Field( "Types", Types ))
+                ;
+            }))
+        || (Error = Index.Record( "Records"
+            , [&]( std::size_t& C, xerr& )
+            {
+                C = m_Index.m_Records.size();
+            }
+            , [&]( std::size_t i, xerr& Error )
+            {
+                auto&       Entry = m_Index.m_Records[i];
+                std::string Name  { Entry.m_Name.data() };
+                0
+                || (Error = Index.Field( "Name", Name ))
+                || (Error = Index.Field( "Offset", Entry.m_Offset ))
+                || (Error = Index.Field( "Count", Entry.m_Count ))
+                || (Error = Index.Field( "iRowOffset", Entry.m_iRowOffset ))
+                ;
+            }))
+        || (Error = Index.Record( "Rows"
+            , [&]( std::size_t& C, xerr& )
+            {
+                C = m_Index.m_RowOffsets.size();
+            }
+            , [&]( std::size_t i, xerr& Error )
+            {
+                Error = Index.Field( "Offset", m_Index.m_RowOffsets[i] );
+            }))
+        ;
+
+        Index.close();
+        return Error;
     }
 
     //------------------------------------------------------------------------------
-    
-    xerr stream::WriteColumn( crc32 UserType, const char* pColumnName, std::span<details::arglist::types> Args) noexcept
+
+    xerr stream::LoadIndex( void ) noexcept
     {
-        //
-        // Make sure we always have enough memory
-        //
-        if( (m_iMemOffet + 1024*2) > m_Memory.size() ) 
-            m_Memory.resize( m_Memory.size() + 1024*4 );
+        m_Index.clear();
 
-        //
-        // When we are at the first line we must double check the syntax of the user_types
-        //
-        if( m_iLine == 0 )
+        std::error_code Ec;
+        const auto FileSize = std::filesystem::file_size( m_FilePath, Ec );
+        if( Ec ) return xerr::create_f< state, "Fail to get the size of the indexed file" >();
+
+        const auto FileTime = std::filesystem::last_write_time( m_FilePath, Ec );
+        if( Ec ) return xerr::create_f< state, "Fail to get the time of the indexed file" >();
+
+        stream Index;
+        if( auto Err = Index.Open( true, m_FilePath + L".idx", file_type::BINARY ); Err )
+            return Err;
+
+        xerr Error;
+        xerr::cleanup CleanUp( Error, [&]
         {
-            // Make sure we have enough columns to store our data
-            if( m_Columns.size() <= m_nColumns ) 
-            {
-                m_Columns.push_back({});
-            }
-            else
+            Index.close();
+            m_Index.clear();
+        });
+
+        int             Version = 0;
+        int             RowStep = 0;
+        std::int64_t    Size    = 0;
+        std::int64_t    Time    = 0;
+        if( Error = Index.Record( "Index"
+            , [&]( xerr& Error )
             {
-                m_Columns[m_nColumns].clear();
-            }
+                0
+                || (Error = Index.Field( "Version", Version ))
+                || (Error = Index.Field( "RowStep", RowStep ))
+                || (Error = Index.Field( "FileSize", Size ))
+                || (Error = Index.Field( "FileTime", Time ))
+                ;
+            }); Error ) return Error;
+
+        if( Version != m_IndexVersion || RowStep != m_nIndexRowStep )
+            return Error = xerr::create_f< state, "The .idx sidecar was saved with a different version" >();
+
+        if( Size != static_cast<std::int64_t>(FileSize) || Time != static_cast<std::int64_t>(FileTime.time_since_epoch().count()) )
+            return Error = xerr::create_f< state, "The .idx sidecar is out of date, it needs to be built again" >();
+
+        // Tables with no entries are not saved
+        if( Index.getRecordName() == "UserTypes" )
+        {
+            if( Error = Index.Record( "UserTypes"
+                , [&]( std::size_t&, xerr& ){}
+                , [&]( std::size_t, xerr& Error )
+                {
+                    std::string Name, Types;
+                    if( (Error = Index.Field( "Name", Name )) || (Error = Index.Field( "Types", Types )) )
+                        return;
 
-            auto& Column = m_Columns[m_nColumns++];
-            
-            assert( Args.size() > 0 );
-            Column.m_nTypes   = static_cast<int>(Args.size());
-            Column.m_UserType = UserType;
+                    if( Name.size() >= user_defined_types{}.m_Name.size() || Types.size() >= user_defined_types{}.m_SystemTypes.size() )
+                    {
+                        Error = xerr::create_f< state, "Found a user type in the .idx sidecar that is way too long" >();
+                        return;
+                    }
 
-            // Copy name of the field
-            for( Column.m_NameLength=0; (Column.m_Name[Column.m_NameLength] = pColumnName[Column.m_NameLength]); Column.m_NameLength++ )
-            {
-                // Handle dynamic types
-                if( pColumnName[Column.m_NameLength] == ':' && pColumnName[Column.m_NameLength+1] == '?' )
+                    AddUserType( user_defined_types{ Name.c_str(), Types.c_str() } );
+                }); Error ) return Error;
+        }
+
+        if( Index.getRecordName() == "Records" )
+        {
+            if( Error = Index.Record( "Records"
+                , [&]( std::size_t& C, xerr& )
                 {
-                    Column.m_nTypes                     = -1;
-                    Column.m_UserType.m_Value           = 0;
-                    Column.m_Name[Column.m_NameLength]  = 0;
-                    break;
+                    m_Index.m_Records.resize( C );
                 }
+                , [&]( std::size_t i, xerr& Error )
+                {
+                    auto&       Entry = m_Index.m_Records[i];
+                    std::string Name;
+                    0
+                    || (Error = Index.Field( "Name", Name ))
+                    || (Error = Index.Field( "Offset", Entry.m_Offset ))
+                    || (Error = Index.Field( "Count", Entry.m_Count ))
+                    || (Error = Index.Field( "iRowOffset", Entry.m_iRowOffset ))
+                    ;
+                    if( Error ) return;
+
+                    if( Name.size() >= Entry.m_Name.size() )
+                    {
+                        Error = xerr::create_f< state, "Found a record name in the .idx sidecar that is way too long" >();
+                        return;
+                    }
 
-                // Make sure the field name falls inside these constraints 
-                assert(  (pColumnName[Column.m_NameLength] >= 'a' && pColumnName[Column.m_NameLength] <= 'z')
-                     ||  (pColumnName[Column.m_NameLength] >= 'A' && pColumnName[Column.m_NameLength] <= 'Z')
-                     ||  (pColumnName[Column.m_NameLength] >= '0' && pColumnName[Column.m_NameLength] <= '9')
-                     ||  (pColumnName[Column.m_NameLength] == '_' ) 
-                );
-            }
+                    strcpy_s( Entry.m_Name.data(), Entry.m_Name.size(), Name.c_str() );
+                }); Error ) return Error;
         }
 
-        //
-        // Get the column we are processing
-        //
-        auto& Column = m_Columns[ m_iColumn++ ];
-
-        //
-        // Validate the user_types type if any
-        //
-#ifdef _DEBUG
+        if( Index.getRecordName() == "Rows" )
         {
-            if( UserType.m_Value && ( Column.m_nTypes == -1 || m_iLine==0 ) )
-            {
-                auto pUserType = getUserType( UserType );
-                    
-                // Make sure the user_types register this user_types type
-                assert(pUserType);
-                assert(pUserType->m_nSystemTypes == Args.size() );
-                for( auto& A  : Args )
+            if( Error = Index.Record( "Rows"
+                , [&]( std::size_t& C, xerr& )
                 {
-                    assert(isCompatibleTypes( pUserType->m_SystemTypes[ static_cast<std::size_t>( &A - Args.data() )], A ));
+                    m_Index.m_RowOffsets.resize( C );
                 }
-            }
+                , [&]( std::size_t i, xerr& Error )
+                {
+                    Error = Index.Field( "Offset", m_Index.m_RowOffsets[i] );
+                }); Error ) return Error;
         }
-#endif
+
+        Index.close();
+        m_Index.m_bLoaded = true;
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Collects what a file that is about to be appended already has. Checks that its signature
+    //      matches the requested type, gets its user types and its record offsets for the .idx
+    //      sidecar or the footer. A text file with an up to date sidecar, or a binary file with a
+    //      footer, does not need to be read at all (only files without them are walked).
+    //------------------------------------------------------------------------------
+    xerr stream::LoadForAppend( std::wstring_view FilePath, file_type FileType ) noexcept
+    {
         //
-        // Create all the fields for this column
+        // Check the signature
         //
-        if( Column.m_nTypes == -1 || m_iLine == 0 )
         {
-            //
-            // If is a dynamic type we must add the infos
-            //
-            if( Column.m_nTypes == -1 )
-            {
-                auto& DynamicFields = Column.m_DynamicFields.emplace_back();
-                DynamicFields.m_nTypes   = static_cast<int>(Args.size());
-                DynamicFields.m_UserType = UserType;
-                DynamicFields.m_iField   = static_cast<int>(Column.m_FieldInfo.size());
-            }
+            details::file   File;
+            std::uint32_t   Signature = 0;
 
-            //
-            // Write each of the fields types
-            //
-            {
-                auto& FieldInfo = (Column.m_nTypes == -1) ? Column.m_DynamicFields.back() : Column; 
-                for( auto& A : Args )
-                {
-                    FieldInfo.m_SystemTypes[static_cast<std::size_t>(&A - Args.data())] = std::visit( [&]( auto Value ) constexpr
-                    {
-                        using t = std::decay_t<decltype(Value)>;
-                                if constexpr ( std::is_same_v<t,bool*>               ) return 'c';
-//                        else    if constexpr ( std::is_same_v<t,char*>               ) return 'c';
-                        else    if constexpr ( std::is_same_v<t,std::uint8_t*>       ) return 'h';
-                        else    if constexpr ( std::is_same_v<t,std::uint16_t*>      ) return 'H';
-                        else    if constexpr ( std::is_same_v<t,std::uint32_t*>      ) return 'g';
-                        else    if constexpr ( std::is_same_v<t,std::uint64_t*>      ) return 'G';
-                        else    if constexpr ( std::is_same_v<t,std::int8_t*>        ) return 'c';
-                        else    if constexpr ( std::is_same_v<t,std::int16_t*>       ) return 'C';
-                        else    if constexpr ( std::is_same_v<t,std::int32_t*>       ) return 'd';
-                        else    if constexpr ( std::is_same_v<t,std::int64_t*>       ) return 'D';
-                        else    if constexpr ( std::is_same_v<t,float*>              ) return 'f';
-                        else    if constexpr ( std::is_same_v<t,double*>             ) return 'F';
-                        else    if constexpr ( std::is_same_v<t,std::string*>        ) return 's';
-                        else    if constexpr ( std::is_same_v<t,std::wstring*>       ) return 'S';
-                        else    { assert(false); return char{0}; }
-                    }, A );
-                }
+            if( auto Err = File.openForReading( FilePath, true ); Err )
+                return Err;
 
-                // Terminate types as a proper string
-                FieldInfo.m_SystemTypes[ static_cast<int>(Args.size()) ] = 0;
+            if( auto Err = File.Read( Signature ); Err )
+            {
+                if( Err.getState<state>() != state::UNEXPECTED_EOF )
+                    return Err;
+                Err.clear();
             }
+
+            // Binary files can have any endian and revision, the records that we add will match them
+            details::states States;
+            if( signature::Decode( Signature, States ) != (FileType == file_type::BINARY) )
+                return xerr::create_f< state, "The file to append to is not of the requested type" >();
         }
 
         //
-        // Ready to buffer the actual fields
+        // Text files with an up to date sidecar already have everything we need
         //
-        if( m_File.m_States.m_isBinary )
-        {
-            //
-            // Write to a buffer the data
-            //
-            for( auto& A : Args )
-            {
-                auto& FieldInfo = Column.m_FieldInfo.emplace_back(); 
+        m_FilePath = FilePath;
 
-                std::visit( [&]( auto p ) constexpr
-                {
-                    using T = std::decay_t<decltype(p)>;
+        std::error_code Ec;
+        if( FileType == file_type::TEXT && std::filesystem::exists( m_FilePath + L".idx", Ec ) )
+        {
+            if( auto Err = LoadIndex(); Err ) Err.clear();
+            else                              return {};
+        }
 
-                    if constexpr( std::is_same_v<T, std::string*> )
-                    {
-                        FieldInfo.m_iData = m_iMemOffet;
-
-                        std::string_view a(m_Memory.begin() + FieldInfo.m_iData, m_Memory.end());
-
-                        m_iMemOffet += Strcpy_s(const_cast<char*>(a.data()), a.size(), p->c_str());
-                        FieldInfo.m_Width = m_iMemOffet - FieldInfo.m_iData;
-                    }
-                    else if constexpr (std::is_same_v<T, std::wstring*>)
-                    {
-                        FieldInfo.m_iData = align_to(m_iMemOffet, 2);
-                        m_iMemOffet = FieldInfo.m_iData;
+        // Binary files with a footer have it all at their end
+        if( FileType == file_type::BINARY )
+        {
+            xerr Error = openForReading( FilePath );
+            if( !Error ) Error = LoadFooter();
+            close();
 
-                        if ( p->empty() == false )
-                        {
-                            auto length = static_cast<int>(p->length() * sizeof(wchar_t));
-                            memcpy( &m_Memory[m_iMemOffet], p->data(), length );
-                            if (m_File.m_States.m_isEndianSwap)
-                            {
-                                for (int i=0; i< length; i += 2 )
-                                {
-                                    auto& X = reinterpret_cast<std::uint16_t&>(m_Memory[m_iMemOffet + i]);
-                                    X = endian::Convert(X);
-                                }
-                            }
-                            m_iMemOffet += length;
-                        }
+            if( !Error ) return {};
+            Error.clear();
 
-                        // make sure it is properly terminated
-                        m_Memory[m_iMemOffet++] = 0;
-                        m_Memory[m_iMemOffet++] = 0;
+            m_Index.clear();
+            m_UserTypes.clear();
+            m_UserTypeMap.clear();
+        }
 
-                        FieldInfo.m_Width = m_iMemOffet - FieldInfo.m_iData;
-                    }
-                    else
-                    {
-                        if constexpr ( std::is_pointer_v<T> == false 
-                            || std::is_same_v<T,void*> 
-                            || std::is_same_v<T,const char*>
-                            || std::is_same_v<T, const wchar_t*> )
-                        {
-                            assert(false);
-                        }
-                        else 
-                        {
-                            if constexpr (std::is_same_v<T,bool*> )
-                            {
-                                // No taken any changes with bools... let us make sure that they are 1 byte
-                                static_assert (std::is_pointer_v<T>);
-                                constexpr auto size = sizeof(std::uint8_t);
-                                FieldInfo.m_Width = size;
-                                FieldInfo.m_iData = align_to(m_iMemOffet, 1);
-                                m_iMemOffet = FieldInfo.m_iData + FieldInfo.m_Width;
+        // Otherwise we walk the file without decoding it
+        return WalkFile( FilePath, true );
+    }
 
-                                auto& x = reinterpret_cast<std::uint8_t&>(m_Memory[FieldInfo.m_iData]);
-                                x = *p?1:0;
-                            }
-                            else
-                            {
-                                static_assert ( std::is_pointer_v<T> );
-                                constexpr auto size = sizeof(decltype(*p)); 
-                                FieldInfo.m_Width = size;
-                                FieldInfo.m_iData = align_to( m_iMemOffet, std::alignment_of_v<decltype(*p)> );
-                                m_iMemOffet = FieldInfo.m_iData + FieldInfo.m_Width;
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Binary files written with flags::m_isWriteIndex end with a table of their records so
+    //      SeekRecord can go straight to any of them (numbers in the endian of the file):
+    //
+    //          '>' nRecords:u32 { NameCRC:u32 Offset:i64 Count:i32 bLabel:u8 }
+    //              nUserTypes:u32 { Name\0 SystemTypes\0 } FooterOffset:i64 'TOC1':u32
+    //
+    //      The user types are in it since the record that we jump to may use types that were
+    //      written before it. ReadRecord stops at the '>' so the records are read as always.
+    //------------------------------------------------------------------------------
+    constexpr static std::uint32_t s_FooterMagic = std::uint32_t('TOC1');
 
-                                if constexpr ( size ==  1 ) 
-                                {
-                                    auto& x = reinterpret_cast<std::uint8_t& >(m_Memory[FieldInfo.m_iData]);
-                                    x = reinterpret_cast<std::uint8_t&>(*p);
-                                }
-                                else    if constexpr ( size == 2 ) 
-                                {
-                                    auto& x = reinterpret_cast<std::uint16_t& >(m_Memory[FieldInfo.m_iData]);
-                                    x = reinterpret_cast<std::uint16_t&>(*p);
-                                    if (m_File.m_States.m_isEndianSwap) x = endian::Convert(x);
-                                }
-                                else    if constexpr ( size == 4 ) 
-                                {
-                                    auto& x = reinterpret_cast<std::uint32_t& >(m_Memory[FieldInfo.m_iData]);
-                                    x = reinterpret_cast<std::uint32_t&>(*p);
-                                    if( m_File.m_States.m_isEndianSwap ) x = endian::Convert(x);
-                                }
-                                else    if constexpr ( size == 8 ) 
-                                {
-                                    auto& x = reinterpret_cast<std::uint64_t& >(m_Memory[FieldInfo.m_iData]);
-                                    x = reinterpret_cast<std::uint64_t&>(*p);
-                                    if( m_File.m_States.m_isEndianSwap )  x = endian::Convert(x);
-                                }
-                                else
-                                {
-                                    assert(false);
-                                }
-                            }
-                        }
-                    }
-                }, A );
-            }
-        }
-        else
+    xerr stream::WriteFooter( void ) noexcept
+    {
+        auto Write = [&]( auto Value ) -> xerr
         {
-            //
-            // Lambda Used to write the fields
-            //
-            auto Numerics = [&]( details::field_info& FieldInfo, auto p, const char* pFmt ) noexcept
+            if( m_File.m_States.m_isEndianSwap )
             {
-                using T = std::decay_t<decltype(p)>;
+                if constexpr ( sizeof(Value) == 4 ) Value = static_cast<decltype(Value)>( endian::Convert( static_cast<std::uint32_t>(Value) ) );
+                if constexpr ( sizeof(Value) == 8 ) Value = static_cast<decltype(Value)>( endian::Convert( static_cast<std::uint64_t>(Value) ) );
+            }
+            return m_File.Write( Value );
+        };
 
-                FieldInfo.m_iData = m_iMemOffet;
-                std::string_view temp(m_Memory.begin() + m_iMemOffet, m_Memory.end() );
-                m_iMemOffet += 1 + sprintf_s(const_cast<char*>(temp.data()), temp.size(), pFmt, p);
-                FieldInfo.m_Width = m_iMemOffet - FieldInfo.m_iData - 1;
+        const std::int64_t FooterOffset = m_File.Tell();
 
-                if constexpr ( std::is_integral_v<T> )
-                {
-                    FieldInfo.m_IntWidth = FieldInfo.m_Width;
-                }
-                else
-                {
-                    for( FieldInfo.m_IntWidth = 0; m_Memory[FieldInfo.m_iData + FieldInfo.m_IntWidth] != '.' && m_Memory[FieldInfo.m_iData+FieldInfo.m_IntWidth]; FieldInfo.m_IntWidth++ );
-                }
-            };
+        if( auto Err = m_File.WriteChar( '>' ); Err )
+            return Err;
 
-            //
-            // Write to a buffer the data
-            //
-            for( auto& A : Args )
-            {
-                auto& Field = Column.m_FieldInfo.emplace_back(); 
+        if( auto Err = Write( static_cast<std::uint32_t>(m_Index.m_Records.size()) ); Err )
+            return Err;
 
-                std::visit( [&]( auto p ) constexpr
-                {
-                    using t = std::decay_t<decltype(p)>;
-                            if constexpr ( std::is_same_v<t,std::uint8_t*>      ) Numerics( Field, *p, "#%X" );
-                    else    if constexpr ( std::is_same_v<t,std::uint16_t*>     ) Numerics( Field, *p, "#%X" );
-                    else    if constexpr ( std::is_same_v<t,std::uint32_t*>     ) Numerics( Field, *p, "#%X" );
-                    else    if constexpr ( std::is_same_v<t,std::uint64_t*>     ) Numerics( Field, *p, "#%llX" );
-                    else    if constexpr ( std::is_same_v<t,bool*>              ) Numerics( Field, (int)*p, "%d" );
-                    else    if constexpr ( std::is_same_v<t,std::int8_t*>       ) Numerics( Field, *p, "%d" );
-                    else    if constexpr ( std::is_same_v<t,std::int16_t*>      ) Numerics( Field, *p, "%d" );
-                    else    if constexpr ( std::is_same_v<t,std::int32_t*>      ) Numerics( Field, *p, "%d" );
-                    else    if constexpr ( std::is_same_v<t,std::int64_t*>      ) Numerics( Field, *p, "%lld" );
-                    else    if constexpr ( std::is_same_v<t,float*>             ) 
-                            { 
-                                if( m_File.m_States.m_isSaveFloats )    Numerics( Field, static_cast<double>(*p), "%.9g" );
-                                else                                    Numerics( Field, reinterpret_cast<std::uint32_t&>(*p),  "#%X" ); 
-                            }
-                    else    if constexpr ( std::is_same_v<t,double*>            ) 
-                            { 
-                                if( m_File.m_States.m_isSaveFloats )    Numerics( Field, *p, "%.17g" );
-                                else                                    Numerics( Field, reinterpret_cast<std::uint64_t&>(*p),  "#%llX" ); 
-                            }
-                    else    if constexpr ( std::is_same_v<t, std::string*> )
-                            {
-                                Field.m_iData = m_iMemOffet;
-                                std::string_view temp(m_Memory.begin() + Field.m_iData, m_Memory.end() );
-                                m_iMemOffet += 1 + sprintf_s(const_cast<char*>(temp.data()), temp.size(), "\"%s\"", p->c_str());
-                                Field.m_Width = m_iMemOffet - Field.m_iData - 1;
-                            }
-                    else    if constexpr (std::is_same_v<t, std::wstring*>)
-                            {
-                                Field.m_iData = m_iMemOffet;
-                                std::string temp = details::wstring_to_ascii_escape( *p );
+        for( const auto& Entry : m_Index.m_Records )
+        {
+            // The entries that came from the footer of the file we append to only have the CRC
+            const crc32 NameCRC = Entry.m_Name[0] ? crc32::computeFromString( Entry.m_Name.data() ) : Entry.m_NameCRC;
+            if( auto Err = Write( NameCRC.m_Value ); Err )                                        return Err;
+            if( auto Err = Write( Entry.m_Offset ); Err )                                         return Err;
+            if( auto Err = Write( Entry.m_Count ); Err )                                          return Err;
+            if( auto Err = Write( static_cast<std::uint8_t>(Entry.m_bLabel) ); Err )              return Err;
+        }
 
-                                m_Memory[m_iMemOffet++] = '"';
-                                for (auto E : temp) m_Memory[m_iMemOffet++] = E;
-                                m_Memory[m_iMemOffet++] = '"';
-                                m_Memory[m_iMemOffet++] = 0;
+        if( auto Err = Write( static_cast<std::uint32_t>(m_UserTypes.size()) ); Err )
+            return Err;
 
-                                Field.m_Width = m_iMemOffet - Field.m_iData - 1;
-                            }
-                    else
-                    { 
-                        assert(false); 
-                    }
-                }, A );
-            }
+        for( const auto& UserType : m_UserTypes )
+        {
+            if( auto Err = m_File.WriteStr( { UserType.m_Name.data(), static_cast<std::size_t>(UserType.m_NameLength + 1) } ); Err )
+                return Err;
+
+            if( auto Err = m_File.WriteStr( { UserType.m_SystemTypes.data(), static_cast<std::size_t>(UserType.m_nSystemTypes + 1) } ); Err )
+                return Err;
         }
 
-        return {};
+        if( auto Err = Write( FooterOffset ); Err )
+            return Err;
+
+        return Write( s_FooterMagic );
     }
 
     //------------------------------------------------------------------------------
 
-    xerr stream::WriteLine( void ) noexcept
+    xerr stream::LoadFooter( void ) noexcept
     {
-        assert( m_File.m_States.m_isReading == false );
+        auto Read = [&]( auto& Value ) -> xerr
+        {
+            if( auto Err = m_File.Read( Value ); Err )
+                return Err;
 
-        // Make sure that the user_types don't try to write more lines than expected
-        assert( m_iLine < m_Record.m_Count );
+            if( m_File.m_States.m_isEndianSwap )
+            {
+                using t = std::decay_t<decltype(Value)>;
+                if constexpr ( sizeof(t) == 4 ) Value = static_cast<t>( endian::Convert( static_cast<std::uint32_t>(Value) ) );
+                if constexpr ( sizeof(t) == 8 ) Value = static_cast<t>( endian::Convert( static_cast<std::uint64_t>(Value) ) );
+            }
+            return {};
+        };
+
+        constexpr std::int64_t TrailerSize = sizeof(std::int64_t) + sizeof(std::uint32_t);
+
+        std::error_code Ec;
+        const auto      FileSize = static_cast<std::int64_t>( std::filesystem::file_size( m_FilePath, Ec ) );
+        if( Ec || FileSize < TrailerSize )
+            return xerr::create_f< state, "Unable to get the size of the binary file" >();
 
         //
-        // Increment the line count
-        // and reset the column index
+        // The trailer tells where the footer starts
         //
-        m_iLine++;
-        m_iColumn   = 0;
+        std::int64_t  FooterOffset = 0;
+        std::uint32_t Magic        = 0;
+
+        if( auto Err = m_File.SeekSet( FileSize - TrailerSize ); Err ) return Err;
+        if( auto Err = Read( FooterOffset ); Err )                      return Err;
+        if( auto Err = Read( Magic ); Err )                             return Err;
+
+        if( Magic != s_FooterMagic || FooterOffset <= 0 || FooterOffset >= FileSize - TrailerSize )
+            return xerr::create_f< state, "The binary file does not have a footer, write it with flags::m_isWriteIndex" >();
+
+        if( auto Err = m_File.SeekSet( FooterOffset ); Err )
+            return Err;
+
+        int c;
+        if( auto Err = m_File.getC(c); Err )
+            return Err;
+
+        if( c != '>' )
+            return xerr::create_f< state, "The footer of the binary file is not where its trailer says" >();
 
         //
-        // We will wait writing the line if we can so we can format
+        // Records
         //
-        if( (m_iLine < m_Record.m_Count && (m_iLine%m_nLinesBeforeFileWrite) != 0) )
+        m_Index.clear();
+
+        std::uint32_t nRecords;
+        if( auto Err = Read( nRecords ); Err )
+            return Err;
+
+        m_Index.m_Records.resize( nRecords );
+        for( auto& Entry : m_Index.m_Records )
         {
-            return {};
+            std::uint8_t bLabel;
+            if( auto Err = Read( Entry.m_NameCRC.m_Value ); Err ) return Err;
+            if( auto Err = Read( Entry.m_Offset ); Err )          return Err;
+            if( auto Err = Read( Entry.m_Count ); Err )           return Err;
+            if( auto Err = Read( bLabel ); Err )                  return Err;
+            Entry.m_bLabel = bLabel != 0;
         }
 
-
         //
-        // Lets handle the binary case first
+        // User types of the whole file (in the same order so the binary indices match)
         //
-        if( m_File.m_States.m_isBinary )
+        std::uint32_t nUserTypes;
+        if( auto Err = Read( nUserTypes ); Err )
+            return Err;
+
+        for( std::uint32_t i = 0; i < nUserTypes; ++i )
         {
-            if( m_iLine <= m_nLinesBeforeFileWrite )
+            std::array<std::array<char,64>, 2> Strings;
+            for( auto& String : Strings )
             {
-                //
-                // Write any pending user_types types
-                //
-                if( auto Err = WriteUserTypes(); Err)
-                    return Err;
-            
-                //
-                // Write record header
-                //
-
-                // First handle the case that is a label  
-                if( m_nColumns == -1 )
+                int n = 0;
+                do
                 {
-                    if (auto Err = m_File.WriteChar('@'); Err)
+                    if( auto Err = m_File.getC(c); Err )
                         return Err;
 
-                    if (auto Err = m_File.WriteChar('['); Err)
-                        return Err;
+                    if( n >= static_cast<int>(String.size()) )
+                        return xerr::create_f< state, "Found a user type in the footer that is way too long" >();
 
-                    if (auto Err = m_File.WriteStr({ m_Record.m_Name.data(), std::strlen(m_Record.m_Name.data()) + 1 }); Err )
-                        return Err;
+                    String[n++] = static_cast<char>(c);
+                } while( c );
+            }
 
-                    goto CLEAR;
-                }
+            AddUserType( user_defined_types{ Strings[0].data(), Strings[1].data() } );
+        }
 
-                if( auto Err = m_File.WriteChar( '[' ); Err )
-                    return Err;
+        m_Index.m_FooterOffset = FooterOffset;
+        m_Index.m_bLoaded      = true;
+        return {};
+    }
 
-                if( auto Err = m_File.WriteStr( { m_Record.m_Name.data(), std::strlen( m_Record.m_Name.data() )+1 } ); Err )
-                    return Err;
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Moves a text file that is being read to the given record using its .idx sidecar.
+    //      Binary files use their footer instead.
+    //      When iRow is not zero the record will look as if it started at that row, so
+    //      getRecordCount returns the rows that are left. For text the cost is a seek plus
+    //      parsing (without decoding) less than m_nIndexRowStep rows. Binary records go straight
+    //      to the row but only when all their fields have a fixed size.
+    //      nRows (when not -1) limits how many rows the record will have. The rows after them
+    //      are skipped, so the record that follows gets read as usual.
+    //------------------------------------------------------------------------------
+    xerr stream::SeekRecord( std::string_view RecordName, int iRow, int nRows ) noexcept
+    {
+        assert( m_File.m_States.m_isReading );
 
-                if( auto Err = m_File.Write( m_Record.m_Count ); Err )
-                    return Err;
+        m_NextRecordOffset = 0;
 
-                //
-                // Write types
-                //
-                {
-                    std::uint8_t nColumns = static_cast<std::uint8_t>(m_nColumns);
-                    if( auto Err = m_File.Write( nColumns ); Err ) 
-                        return Err;
-                }
+        if( m_Index.m_bLoaded == false )
+        {
+            if( auto Err = m_File.m_States.m_isBinary ? LoadFooter() : LoadIndex(); Err )
+                return Err;
+        }
 
-                for( int i=0; i<m_nColumns; ++i )
-                {
-                    auto& Column = m_Columns[i];
+        // The footer of binary files only has the CRC of the names
+        const crc32 NameCRC = crc32::computeFromString( std::string( RecordName ).c_str() );
+        const auto  It      = std::find_if( m_Index.m_Records.begin(), m_Index.m_Records.end(), [&]( const details::index_record& Entry )
+        {
+            return m_File.m_States.m_isBinary ? Entry.m_NameCRC == NameCRC : RecordName == Entry.m_Name.data();
+        });
 
-                    if( auto Err = m_File.WriteStr( std::string_view{ Column.m_Name.data(), static_cast<std::size_t>(Column.m_NameLength) } ); Err )
-                        return Err;
+        if( It == m_Index.m_Records.end() )
+            return xerr::create< state::RECORD_NOT_FOUND, "Unable to find the record in the .idx sidecar" >();
 
-                    if( Column.m_nTypes == -1 )
-                    {
-                        if( auto Err = m_File.WriteChar( '?' ); Err )
-                            return Err;
-                    }
-                    else
-                    {
-                        if( Column.m_UserType.m_Value )
-                        {
-                            if( auto Err = m_File.WriteChar( ';' ); Err )
-                                return Err;
+        if( iRow < 0 || (iRow && iRow >= It->m_Count) || nRows < -1 )
+            return xerr::create_f< state, "The requested row is outside of the record" >();
 
-                            std::uint8_t Index = static_cast<std::uint8_t>(getUserType(Column.m_UserType) - m_UserTypes.data());  // m_UserTypes.getIndexByEntry<std::uint8_t>( *getUserType(Column.m_UserType) );
-                            if( auto Err = m_File.Write( Index ); Err )
-                                return Err;
-                        }
-                        else
-                        {
-                            if( auto Err = m_File.WriteChar( ':' ); Err )
-                                return Err;
+        //
+        // Read the record header
+        //
+        if( auto Err = m_File.SeekSet( It->m_Offset ); Err )
+            return Err;
 
-                            if( auto Err = m_File.WriteStr( { Column.m_SystemTypes.data(), static_cast<std::size_t>(Column.m_nTypes + 1) } ); Err )
+        if( auto Err = ReadRecord(); Err )
+            return Err;
+
+        if( iRow )
+        {
+            if( auto Err = ReadTypes(); Err )
+                return Err;
+
+            if( auto Err = m_File.m_States.m_isBinary ? SkipBinaryRows( iRow ) : SkipTextRows( It->m_iRowOffset, iRow ); Err )
+                return Err;
+
+            // Now the record starts at the requested row
+            m_Record.m_Count -= iRow;
+            m_iLine           = 0;
+        }
+
+        //
+        // Only some of the rows get read so the next ReadRecord jumps to the record that follows
+        //
+        if( nRows != -1 && nRows < m_Record.m_Count )
+        {
+            m_Record.m_Count = nRows;
+
+            if( const auto Next = std::next(It); Next != m_Index.m_Records.end() )
+            {
+                m_NextRecordOffset = Next->m_Offset;
+            }
+            else if( m_File.m_States.m_isBinary )
+            {
+                m_NextRecordOffset = m_Index.m_FooterOffset;
+            }
+            else
+            {
+                std::error_code Ec;
+                m_NextRecordOffset = static_cast<std::int64_t>( std::filesystem::file_size( m_FilePath, Ec ) );
+                if( Ec ) return xerr::create_f< state, "Unable to get the size of the file" >();
+            }
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Rows of binary records with fixed size fields are all the same size so row iRow is
+    //      at a known offset from the first one (the types were just read). With blocks the
+    //      ones before the row are skipped using their size.
+    //------------------------------------------------------------------------------
+    xerr stream::SkipBinaryRows( int iRow ) noexcept
+    {
+        PlanFixedRows();
+        if( m_FixedRows.m_RowBytes == 0 )
+            return xerr::create_f< state, "Binary files can only seek to a row of a record that has fixed size fields" >();
+
+        if( m_File.m_States.m_isBlocks )
+        {
+            int nSkip = iRow;
+            while( true )
+            {
+                if( auto Err = ReadBlockHeader(); Err )
+                    return Err;
+
+                if( nSkip < m_BlockCursor.m_nLeft )
+                    break;
+
+                nSkip -= m_BlockCursor.m_nLeft;
+                if( auto Err = m_File.SeekSet( m_BlockCursor.m_End ); Err )
+                    return Err;
+            }
+
+            if( auto Err = UnpackBlock(); Err )
+                return Err;
+
+            // The record will start at the row
+            m_BlockCursor.m_nLeft -= nSkip;
+            m_BlockCursor.m_nRows -= iRow;
+            return m_File.Skip( nSkip * m_FixedRows.m_RowBytes );
+        }
+
+        return m_File.SeekSet( m_File.Tell() + static_cast<std::int64_t>(iRow) * m_FixedRows.m_RowBytes );
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Jumps to the closest row of the text record that the sidecar knows about (the types
+    //      were just read) and parses the rest of the rows until iRow.
+    //------------------------------------------------------------------------------
+    xerr stream::SkipTextRows( int iFirstRowOffset, int iRow ) noexcept
+    {
+        int nSkip = iRow;
+        if( iRow >= m_nIndexRowStep )
+        {
+            const int iRowOffset = iFirstRowOffset + iRow / m_nIndexRowStep - 1;
+            if( iRowOffset >= static_cast<int>(m_Index.m_RowOffsets.size()) )
+                return xerr::create_f< state, "The .idx sidecar does not have the rows of the record" >();
+
+            if( auto Err = m_File.SeekSet( m_Index.m_RowOffsets[iRowOffset] ); Err )
+                return Err;
+
+            nSkip = iRow % m_nIndexRowStep;
+        }
+
+        //
+        // Parse the rest of the rows without decoding them
+        // (the tokens are kept since the rows that follow may repeat them with ^)
+        //
+        ApplyColumnSelection();
+
+        const bool bDeferDecode = m_bDeferDecode;
+        m_bDeferDecode = true;
+        m_iLine        = 1;
+        for( int i=0; i<nSkip; ++i )
+        {
+            if( auto Err = ReadLine(); Err )
+            {
+                m_bDeferDecode = bDeferDecode;
+                return Err;
+            }
+        }
+        m_bDeferDecode = bDeferDecode;
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Moves past the rows of the record that was read with ReadRecord (the ones that are
+    //      left when some were read already) and reads the header of the record that follows.
+    //      None of the rows get decoded. Binary files jump over the record with a single seek
+    //      when the footer was loaded (see SeekRecord) or when all the fields have a fixed size,
+    //      otherwise only the lengths of the strings are read. Text files look for the next
+    //      header without breaking the rows into fields. Like Record, at the end of the file
+    //      there is no error and isEOF becomes true.
+    //------------------------------------------------------------------------------
+    xerr stream::SkipRecord( void ) noexcept
+    {
+        assert( m_File.m_States.m_isReading );
+
+        // Labels have no rows and a range of rows (see SeekRecord) knows already where to go
+        if( m_Record.m_bLabel == false && m_NextRecordOffset == 0 && m_iLine < m_Record.m_Count )
+        {
+            // At the end of the file ReadRecord fails the same way
+            if( auto Err = m_File.m_States.m_isBinary ? SkipBinaryRecord() : SkipTextRecord(); Err )
+            {
+                if( Err.getState<state>() != state::UNEXPECTED_EOF ) 
+                    return Err;
+            }
+        }
+
+        if( auto Err = ReadRecord(); Err )
+        {
+            if( Err.getState<state>() != state::UNEXPECTED_EOF ) 
+                return Err;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Moves the binary file to the end of the current record (see SkipRecord).
+    //------------------------------------------------------------------------------
+    xerr stream::SkipBinaryRecord( void ) noexcept
+    {
+        //
+        // The footer knows where the next record starts
+        //
+        if( m_Index.m_bLoaded )
+        {
+            const auto It = std::find_if( m_Index.m_Records.begin(), m_Index.m_Records.end(), [&]( const details::index_record& Entry )
+            {
+                return Entry.m_Offset == m_Record.m_Offset;
+            });
+
+            if( It != m_Index.m_Records.end() )
+            {
+                const auto Next = std::next(It);
+                return m_File.SeekSet( Next != m_Index.m_Records.end() ? Next->m_Offset : m_Index.m_FooterOffset );
+            }
+        }
+
+        if( m_iLine == 0 )
+        {
+            if( m_nColumns == 0 )
+            {
+                if( auto Err = ReadTypes(); Err )
+                    return Err;
+            }
+
+            PlanFixedRows();
+        }
+
+        //
+        // Blocks have their size so we only read their headers (the rows that were read ahead are in memory)
+        //
+        if( m_File.m_States.m_isBlocks )
+        {
+            FinishDecodeJobs();
+
+            if( m_BlockCursor.m_nLeft )
+            {
+                if( auto Err = m_File.SeekSet( m_BlockCursor.m_End ); Err )
+                    return Err;
+            }
+
+            while( m_BlockCursor.m_nRows < m_Record.m_Count )
+            {
+                if( auto Err = ReadBlockHeader(); Err )
+                    return Err;
+
+                if( auto Err = m_File.SeekSet( m_BlockCursor.m_End ); Err )
+                    return Err;
+            }
+
+            m_BlockCursor.m_nLeft = 0;
+            m_iLine = m_Record.m_Count;
+            return {};
+        }
+
+        //
+        // The rows all have the same size, the ones that were read ahead are already in memory
+        //
+        if( m_FixedRows.m_RowBytes )
+        {
+            const int nRows = m_Record.m_Count - m_iLine - (m_FixedRows.m_nRows - m_FixedRows.m_iRow);
+            m_iLine = m_Record.m_Count;
+            return m_File.SeekSet( m_File.Tell() + static_cast<std::int64_t>(nRows) * m_FixedRows.m_RowBytes );
+        }
+
+        //
+        // Skip the fields one at a time, strings use their length
+        //
+        const bool bValidateOnly = m_bValidateOnly;
+        m_bValidateOnly = true;
+        ApplyColumnSelection();
+
+        xerr Error;
+        while( m_iLine < m_Record.m_Count )
+        {
+            if( Error = ReadLine(); Error )
+                break;
+        }
+        m_bValidateOnly = bValidateOnly;
+
+        return Error;
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Moves the text file to the next header (see SkipRecord). Rows never start with
+    //      '[', '@' or '<' so the first line that does is the next record. Strings may have
+    //      any character so quotes are tracked, and comments are skipped since they may have
+    //      anything as well.
+    //------------------------------------------------------------------------------
+    xerr stream::SkipTextRecord( void ) noexcept
+    {
+        int  c;
+        bool bLineStart = false;
+        bool bString    = false;
+
+        while( true )
+        {
+            if( auto Err = m_File.getC(c); Err )
+                return Err;
+
+            if( bString )
+            {
+                if( c == '"' ) bString = false;
+            }
+            else if( c == '\n' )
+            {
+                bLineStart = true;
+            }
+            else if( bLineStart && std::isspace(c) )
+            {
+                // Still at the start of the line
+            }
+            else if( bLineStart && (c == '[' || c == '@' || c == '<') )
+            {
+                // Let ReadRecord read it
+                m_File.UngetC(c);
+                m_iLine = m_Record.m_Count;
+                return {};
+            }
+            else if( bLineStart && c == '/' )
+            {
+                do
+                {
+                    if( auto Err = m_File.getC(c); Err )
+                        return Err;
+                } while( c != '\n' );
+            }
+            else
+            {
+                bLineStart = false;
+                if( c == '"' ) bString = true;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Everything written to this stream from now on is written to Output as well, so the
+    //      Record/Field callbacks run once for several files. Output keeps its own file type and
+    //      flags, the user opens and closes it.
+    //------------------------------------------------------------------------------
+    void stream::AddTeeOutput( stream& Output ) noexcept
+    {
+        assert( m_File.m_States.m_isReading == false );
+        assert( Output.m_File.m_States.m_isReading == false );
+        assert( &Output != this );
+
+        // The user types that we already have must be known by the output too
+        for( auto& UserType : m_UserTypes )
+            Output.AddUserType( UserType );
+
+        m_TeeOutputs.push_back( &Output );
+    }
+
+    //------------------------------------------------------------------------------
+
+    std::uint32_t stream::AddUserType( const user_defined_types& UserType ) noexcept
+    {
+        for( auto pTee : m_TeeOutputs )
+            pTee->AddUserType( UserType );
+
+        //
+        // Jobs of RecordsParallel take the index from the stream that runs them (which writes the type)
+        // and the types that the other jobs added before, so the indices are the same as in the file
+        //
+        if( m_pSharedUserTypes )
+        {
+            std::scoped_lock Lock( m_pSharedUserTypes->m_Mutex );
+            auto&            Owner = m_pSharedUserTypes->m_Owner;
+            const auto       Index = Owner.AddUserType( UserType );
+
+            for( auto i = static_cast<std::uint32_t>(m_UserTypes.size()); i < Owner.m_UserTypes.size(); ++i )
+            {
+                auto& Entry = m_UserTypes.emplace_back( Owner.m_UserTypes[i] );
+                Entry.m_bAlreadySaved = true;
+                m_UserTypeMap.insert( {Entry.m_CRC, i} );
+            }
+
+            return Index;
+        }
+
+        if( const auto It = m_UserTypeMap.find(UserType.m_CRC); It != m_UserTypeMap.end() )
+        {
+            const auto Index = It->second;
+            
+            // Make sure that this registered err is fully duplicated
+            assert( UserType.m_SystemTypes == m_UserTypes[Index].m_SystemTypes );
+        
+            // we already have it so we don't need to added again
+            return Index;
+        }
+
+        //
+        // Sanity check the user_types types
+        //
+#ifdef _DEBUG
+        {
+            for( int i=0; UserType.m_Name[i]; i++ )
+            {
+                assert( false == std::isspace(UserType.m_Name[i]) );
+            }
+    
+            for( int i=0; UserType.m_SystemTypes[i]; i++ )
+            {
+                assert( false == std::isspace(UserType.m_SystemTypes[i]) );
+            }
+        }
+#endif
+        //
+        // Fill the entry
+        //
+        std::uint32_t Index  = static_cast<std::uint32_t>(m_UserTypes.size());
+        m_UserTypes.emplace_back(UserType);
+
+        m_UserTypeMap.insert( {UserType.m_CRC, Index} );
+
+        return Index;
+    }
+
+    //------------------------------------------------------------------------------
+    void stream::AddUserTypes( std::span<user_defined_types> UserTypes ) noexcept
+    {
+        for( auto& T : UserTypes )
+            AddUserType( T );
+    }
+
+    //------------------------------------------------------------------------------
+    void stream::AddUserTypes( std::span<const user_defined_types> UserTypes ) noexcept
+    {
+        for( auto& T : UserTypes )
+            AddUserType( T );
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::WriteRecord( const char* pHeaderName, std::size_t Count ) noexcept
+    {
+        assert( pHeaderName );
+        assert( m_File.m_States.m_isReading == false );
+
+        for( auto pTee : m_TeeOutputs )
+        {
+            if( auto Err = pTee->WriteRecord( pHeaderName, Count ); Err )
+                return Err;
+        }
+
+        //
+        // Fill the record info
+        //
+        strcpy_s( m_Record.m_Name.data(), m_Record.m_Name.size(), pHeaderName);
+        m_Record.m_iCountOffset = 0;
+        if( Count == ~0 ) 
+        { 
+            m_Record.m_bWriteCount  = false;  
+            m_Record.m_Count        = 1; 
+        }
+        else if (Count == (~0 - 1))
+        {
+            m_Record.m_bWriteCount  = false;
+            m_Record.m_Count        = 1;
+            m_iLine     = 0;
+            m_nColumns  = -1;
+            return CommitLine();
+        }
+        else
+        { 
+            m_Record.m_bWriteCount  = true; 
+            m_Record.m_Count        = static_cast<int>(Count); 
+        }
+
+        //
+        // Reset the line count
+        //
+        m_iLine         = 0;
+        m_iColumn       = 0;
+        m_iMemOffet     = 0;
+        m_nColumns      = 0;
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    static 
+    bool isCompatibleTypes( char X, details::arglist::types Y ) noexcept
+    {
+        return std::visit([&]( auto Value )
+        {
+            using t = std::decay_t<decltype(Value)>;
+                    if constexpr ( std::is_same_v<t,bool*>               ) return X == 'c';
+            else    if constexpr ( std::is_same_v<t,std::uint8_t*>       ) return X == 'h';
+            else    if constexpr ( std::is_same_v<t,std::uint16_t*>      ) return X == 'H';
+            else    if constexpr ( std::is_same_v<t,std::uint32_t*>      ) return X == 'g';
+            else    if constexpr ( std::is_same_v<t,std::uint64_t*>      ) return X == 'G';
+            else    if constexpr ( std::is_same_v<t,std::int8_t*>        ) return X == 'c';
+            else    if constexpr ( std::is_same_v<t,std::int16_t*>       ) return X == 'C';
+            else    if constexpr ( std::is_same_v<t,std::int32_t*>       ) return X == 'd';
+            else    if constexpr ( std::is_same_v<t,std::int64_t*>       ) return X == 'D';
+            else    if constexpr ( std::is_same_v<t,float*>              ) return X == 'f';
+            else    if constexpr ( std::is_same_v<t,double*>             ) return X == 'F';
+            else    if constexpr ( std::is_same_v<t,std::string*>        ) return X == 's';
+            else    if constexpr ( std::is_same_v<t,std::wstring*>       ) return X == 'S';
+            else    if constexpr ( std::is_same_v<t,std::string_view*>   ) return X == 's';
+            else    if constexpr ( std::is_same_v<t,const char*>         ) return X == 's';
+            else    if constexpr ( std::is_same_v<t,std::u16string_view*>) return X == 'S';
+            else    return false;
+        }, Y );
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::WriteComment( const std::string_view Comment ) noexcept
+    {
+        if( m_File.m_States.m_isReading )
+            return {};
+
+        for( auto pTee : m_TeeOutputs )
+        {
+            if( auto Err = pTee->WriteComment( Comment ); Err )
+                return Err;
+        }
+
+        if( m_File.m_States.m_isBinary )
+        {
+            return {};
+        }
+        else
+        {
+            // The comment goes after the lines that were already written
+            if( auto Err = FlushTextBlocks( 0 ); Err )
+                return Err;
+
+            const auto  length = Comment.length();
+            std::size_t iStart = 0;
+            std::size_t iEnd   = iStart;
+
+            if( auto Err = m_File.WriteChar( '\n' ); Err )
+                return Err;
+
+            do 
+            {
+                if( auto Err = m_File.WriteStr( "//" ); Err )
+                    return Err;
+
+                while( iEnd < length)
+                {
+                    if( Comment[iEnd] == '\n' ) { iEnd++; break; }
+                    else                          iEnd++;
+                }
+
+                if( auto Err = m_File.WriteStr( { Comment.data() + iStart, static_cast<std::size_t>(iEnd - iStart) } ); Err )
+                    return Err;
+
+                if( iEnd == length) break;
+
+                // Get ready for the next line
+                iStart = iEnd++;
+
+            } while( true );
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::WriteUserTypes( void ) noexcept
+    {
+        if( m_File.m_States.m_isBinary )
+        {
+            bool bHaveUserTypes = false;
+            for( auto& UserType : m_UserTypes )
+            {
+                if( UserType.m_bAlreadySaved )
+                    continue;
+            
+                UserType.m_bAlreadySaved = true;
+            
+                // First write the standard symbol for the user_types types
+                if( bHaveUserTypes == false )
+                {
+                    bHaveUserTypes = true;
+                    if( auto Err = m_File.WriteChar( '<' ); Err )
+                        return Err;
+                }
+
+                // Write the name 
+                if( auto Err = m_File.WriteStr( { UserType.m_Name.data(), static_cast<std::size_t>(UserType.m_NameLength + 1) } ); Err )
+                    return Err;
+
+                // Write type/s
+                if( auto Err = m_File.WriteStr( { UserType.m_SystemTypes.data(), static_cast<std::size_t>(UserType.m_nSystemTypes+1) } ); Err )
+                    return Err;
+            }
+        }
+        else
+        {
+            //
+            // Dump all the new types if we have some
+            //
+            bool bNewTypes = false;
+            for( auto& UserType : m_UserTypes )
+            {
+                if( UserType.m_bAlreadySaved )
+                    continue;
+
+                if( bNewTypes == false ) 
+                {
+                    if( auto Err = m_File.WriteStr( "\n// New Types\n< " ); Err ) 
+                        return Err;
+
+                    bNewTypes = true;
+                }
+
+                UserType.m_bAlreadySaved = true;
+                std::array<char,256> temp;
+
+                auto length = sprintf_s( temp.data(), temp.size(), "%s:%s ", UserType.m_Name.data(), UserType.m_SystemTypes.data());
+                if( auto Err = m_File.WriteStr( {temp.data(), static_cast<std::size_t>(length)} ); Err ) 
+                    return Err;
+            }
+
+            if( bNewTypes ) if( auto Err = m_File.WriteStr( ">\n" ); Err ) return Err;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    
+    xerr stream::WriteColumn( crc32 UserType, const char* pColumnName, std::span<details::arglist::types> Args) noexcept
+    {
+        // The values are only read here so the tee outputs can stage them as well
+        for( auto pTee : m_TeeOutputs )
+        {
+            if( auto Err = pTee->WriteColumn( UserType, pColumnName, Args ); Err )
+                return Err;
+        }
+
+        //
+        // Make sure we always have enough memory (strings can be of any size)
+        //
+        {
+            std::size_t Needed = 1024*2;
+            for( auto& A : Args )
+            {
+                Needed += std::visit( []( auto p ) constexpr -> std::size_t
+                {
+                    using T = std::decay_t<decltype(p)>;
+                            if constexpr ( std::is_same_v<T, std::string*> || std::is_same_v<T, std::string_view*> )   return p->size() + 8;
+                    else    if constexpr ( std::is_same_v<T, const char*> )                                            return (p ? std::strlen(p) : 0) + 8;
+                    else    if constexpr ( std::is_same_v<T, std::wstring*> || std::is_same_v<T, std::u16string_view*> ) return p->size() * std::max<std::size_t>( 6, sizeof(wchar_t) ) + 8;
+                    else    return 0;
+                }, A );
+            }
+
+            if( (m_iMemOffet + Needed) > m_Memory.size() ) 
+                m_Memory.resize( std::max( m_Memory.size() + 1024*4, m_iMemOffet + Needed ) );
+        }
+
+        //
+        // When we are at the first line we must double check the syntax of the user_types
+        //
+        if( m_iLine == 0 )
+        {
+            // Make sure we have enough columns to store our data
+            if( m_Columns.size() <= m_nColumns ) 
+            {
+                m_Columns.push_back({});
+            }
+            else
+            {
+                m_Columns[m_nColumns].clear();
+            }
+
+            auto& Column = m_Columns[m_nColumns++];
+            
+            assert( Args.size() > 0 );
+            Column.m_nTypes   = static_cast<int>(Args.size());
+            Column.m_UserType = UserType;
+
+            // Copy name of the field
+            for( Column.m_NameLength=0; (Column.m_Name[Column.m_NameLength] = pColumnName[Column.m_NameLength]); Column.m_NameLength++ )
+            {
+                // Handle dynamic types
+                if( pColumnName[Column.m_NameLength] == ':' && pColumnName[Column.m_NameLength+1] == '?' )
+                {
+                    Column.m_nTypes                     = -1;
+                    Column.m_UserType.m_Value           = 0;
+                    Column.m_Name[Column.m_NameLength]  = 0;
+                    break;
+                }
+
+                // Handle the float precision (Name:.3f or Name:.4g)
+                if( pColumnName[Column.m_NameLength] == ':' )
+                {
+                    const char* p      = &pColumnName[Column.m_NameLength + 1];
+                    bool        bValid = *p++ == '.' && *p >= '0' && *p <= '9';
+                    for( ; bValid && *p >= '0' && *p <= '9'; ++p )
+                    {
+                        Column.m_FloatDigits = Column.m_FloatDigits * 10 + (*p - '0');
+                        bValid               = Column.m_FloatDigits <= 40;
+                    }
+
+                    if( bValid == false || (*p != 'f' && *p != 'g') || p[1] != 0 )
+                    {
+                        m_nColumns--;
+                        return xerr::create_f< state, "The precision of a field must be like Name:.3f or Name:.4g (up to 40 digits)" >();
+                    }
+
+                    Column.m_FloatFormat                = *p;
+                    Column.m_Name[Column.m_NameLength]  = 0;
+                    break;
+                }
+
+                // Make sure the field name falls inside these constraints 
+                assert(  (pColumnName[Column.m_NameLength] >= 'a' && pColumnName[Column.m_NameLength] <= 'z')
+                     ||  (pColumnName[Column.m_NameLength] >= 'A' && pColumnName[Column.m_NameLength] <= 'Z')
+                     ||  (pColumnName[Column.m_NameLength] >= '0' && pColumnName[Column.m_NameLength] <= '9')
+                     ||  (pColumnName[Column.m_NameLength] == '_' ) 
+                );
+            }
+        }
+
+        //
+        // Get the column we are processing
+        //
+        auto& Column = m_Columns[ m_iColumn++ ];
+
+        //
+        // Validate the user_types type if any
+        //
+#ifdef _DEBUG
+        {
+            if( UserType.m_Value && ( Column.m_nTypes == -1 || m_iLine==0 ) )
+            {
+                auto pUserType = getUserType( UserType );
+                    
+                // Make sure the user_types register this user_types type
+                assert(pUserType);
+                assert(pUserType->m_nSystemTypes == Args.size() );
+                for( auto& A  : Args )
+                {
+                    assert(isCompatibleTypes( pUserType->m_SystemTypes[ static_cast<std::size_t>( &A - Args.data() )], A ));
+                }
+            }
+        }
+#endif
+        //
+        // Create all the fields for this column
+        //
+        if( Column.m_nTypes == -1 || m_iLine == 0 )
+        {
+            //
+            // If is a dynamic type we must add the infos
+            //
+            if( Column.m_nTypes == -1 )
+            {
+                auto& DynamicFields = Column.m_DynamicFields.emplace_back();
+                DynamicFields.m_nTypes   = static_cast<int>(Args.size());
+                DynamicFields.m_UserType = UserType;
+                DynamicFields.m_iField   = static_cast<int>(Column.m_FieldInfo.size());
+            }
+
+            //
+            // Write each of the fields types
+            //
+            {
+                auto& FieldInfo = (Column.m_nTypes == -1) ? Column.m_DynamicFields.back() : Column; 
+                for( auto& A : Args )
+                {
+                    FieldInfo.m_SystemTypes[static_cast<std::size_t>(&A - Args.data())] = std::visit( [&]( auto Value ) constexpr
+                    {
+                        using t = std::decay_t<decltype(Value)>;
+                                if constexpr ( std::is_same_v<t,bool*>               ) return 'c';
+//                        else    if constexpr ( std::is_same_v<t,char*>               ) return 'c';
+                        else    if constexpr ( std::is_same_v<t,std::uint8_t*>       ) return 'h';
+                        else    if constexpr ( std::is_same_v<t,std::uint16_t*>      ) return 'H';
+                        else    if constexpr ( std::is_same_v<t,std::uint32_t*>      ) return 'g';
+                        else    if constexpr ( std::is_same_v<t,std::uint64_t*>      ) return 'G';
+                        else    if constexpr ( std::is_same_v<t,std::int8_t*>        ) return 'c';
+                        else    if constexpr ( std::is_same_v<t,std::int16_t*>       ) return 'C';
+                        else    if constexpr ( std::is_same_v<t,std::int32_t*>       ) return 'd';
+                        else    if constexpr ( std::is_same_v<t,std::int64_t*>       ) return 'D';
+                        else    if constexpr ( std::is_same_v<t,float*>              ) return 'f';
+                        else    if constexpr ( std::is_same_v<t,double*>             ) return 'F';
+                        else    if constexpr ( std::is_same_v<t,std::string*>        ) return 's';
+                        else    if constexpr ( std::is_same_v<t,std::wstring*>       ) return 'S';
+                        else    if constexpr ( std::is_same_v<t,std::string_view*>   ) return 's';
+                        else    if constexpr ( std::is_same_v<t,const char*>         ) return 's';
+                        else    if constexpr ( std::is_same_v<t,std::u16string_view*>) return 'S';
+                        else    { assert(false); return char{0}; }
+                    }, A );
+                }
+
+                // Terminate types as a proper string
+                FieldInfo.m_SystemTypes[ static_cast<int>(Args.size()) ] = 0;
+            }
+        }
+
+        //
+        // Ready to buffer the actual fields
+        //
+        if( m_File.m_States.m_isBinary )
+        {
+            //
+            // Write to a buffer the data
+            //
+            for( auto& A : Args )
+            {
+                auto& FieldInfo = Column.m_FieldInfo.emplace_back(); 
+
+                std::visit( [&]( auto p ) constexpr
+                {
+                    using T = std::decay_t<decltype(p)>;
+
+                    if constexpr( std::is_same_v<T, std::string*> || std::is_same_v<T, std::string_view*> || std::is_same_v<T, const char*> )
+                    {
+                        std::string_view View;
+                        if constexpr (std::is_same_v<T, const char*>) { if( p ) View = p; }   // A null string is written as an empty one
+                        else                                          View = *p;
+                        FieldInfo.m_iData = m_iMemOffet;
+
+                        if( m_File.m_States.m_isStringLength ) 
+                            m_iMemOffet += WriteVarint( &m_Memory[m_iMemOffet], static_cast<std::uint32_t>(View.size()) );
+
+                        if( View.size() ) memcpy( &m_Memory[m_iMemOffet], View.data(), View.size() );
+                        m_iMemOffet += static_cast<int>(View.size());
+
+                        if( m_File.m_States.m_isStringLength == false ) 
+                            m_Memory[m_iMemOffet++] = 0;
+
+                        FieldInfo.m_Width = m_iMemOffet - FieldInfo.m_iData;
+                    }
+                    else if constexpr (std::is_same_v<T, std::wstring*> || std::is_same_v<T, std::u16string_view*>)
+                    {
+                        if( m_File.m_States.m_isStringLength )
+                        {
+                            FieldInfo.m_iData = m_iMemOffet;
+                            m_iMemOffet += WriteVarint( &m_Memory[m_iMemOffet], static_cast<std::uint32_t>(p->length() * sizeof(wchar_t) / 2) );   // In 16 bit units
+                        }
+                        else
+                        {
+                            FieldInfo.m_iData = align_to(m_iMemOffet, 2);
+                            m_iMemOffet = FieldInfo.m_iData;
+                        }
+
+                        if ( p->empty() == false )
+                        {
+                            auto length = static_cast<int>(p->length() * sizeof(wchar_t));
+                            if constexpr ( sizeof(typename std::remove_pointer_t<T>::value_type) == sizeof(wchar_t) )
+                            {
+                                memcpy( &m_Memory[m_iMemOffet], p->data(), length );
+                            }
+                            else
+                            {
+                                // Binary files keep the characters as wchar_t
+                                auto* pDest = &m_Memory[m_iMemOffet];
+                                for( auto C : *p )
+                                {
+                                    const wchar_t W = static_cast<wchar_t>(C);
+                                    memcpy( pDest, &W, sizeof(W) );
+                                    pDest += sizeof(W);
+                                }
+                            }
+
+                            if (m_File.m_States.m_isEndianSwap)
+                                endian::SwapBlock( &m_Memory[m_iMemOffet], length / 2, 2 );
+                            m_iMemOffet += length;
+                        }
+
+                        // make sure it is properly terminated
+                        if( m_File.m_States.m_isStringLength == false )
+                        {
+                            m_Memory[m_iMemOffet++] = 0;
+                            m_Memory[m_iMemOffet++] = 0;
+                        }
+
+                        FieldInfo.m_Width = m_iMemOffet - FieldInfo.m_iData;
+                    }
+                    else
+                    {
+                        if constexpr ( std::is_pointer_v<T> == false 
+                            || std::is_same_v<T,void*> 
+                            || std::is_same_v<T,const char*>
+                            || std::is_same_v<T, const wchar_t*> )
+                        {
+                            assert(false);
+                        }
+                        else 
+                        {
+                            if constexpr (std::is_same_v<T,bool*> )
+                            {
+                                // No taken any changes with bools... let us make sure that they are 1 byte
+                                static_assert (std::is_pointer_v<T>);
+                                constexpr auto size = sizeof(std::uint8_t);
+                                FieldInfo.m_Width = size;
+                                FieldInfo.m_iData = align_to(m_iMemOffet, 1);
+                                m_iMemOffet = FieldInfo.m_iData + FieldInfo.m_Width;
+
+                                auto& x = reinterpret_cast<std::uint8_t&>(m_Memory[FieldInfo.m_iData]);
+                                x = *p?1:0;
+                            }
+                            else
+                            {
+                                static_assert ( std::is_pointer_v<T> );
+                                constexpr auto size = sizeof(decltype(*p)); 
+                                FieldInfo.m_Width = size;
+                                FieldInfo.m_iData = align_to( m_iMemOffet, std::alignment_of_v<decltype(*p)> );
+                                m_iMemOffet = FieldInfo.m_iData + FieldInfo.m_Width;
+
+                                if constexpr ( size ==  1 ) 
+                                {
+                                    auto& x = reinterpret_cast<std::uint8_t& >(m_Memory[FieldInfo.m_iData]);
+                                    x = reinterpret_cast<std::uint8_t&>(*p);
+                                }
+                                else    if constexpr ( size == 2 ) 
+                                {
+                                    auto& x = reinterpret_cast<std::uint16_t& >(m_Memory[FieldInfo.m_iData]);
+                                    x = reinterpret_cast<std::uint16_t&>(*p);
+                                    if (m_File.m_States.m_isEndianSwap) x = endian::Convert(x);
+                                }
+                                else    if constexpr ( size == 4 ) 
+                                {
+                                    auto& x = reinterpret_cast<std::uint32_t& >(m_Memory[FieldInfo.m_iData]);
+                                    x = reinterpret_cast<std::uint32_t&>(*p);
+                                    if( m_File.m_States.m_isEndianSwap ) x = endian::Convert(x);
+                                }
+                                else    if constexpr ( size == 8 ) 
+                                {
+                                    auto& x = reinterpret_cast<std::uint64_t& >(m_Memory[FieldInfo.m_iData]);
+                                    x = reinterpret_cast<std::uint64_t&>(*p);
+                                    if( m_File.m_States.m_isEndianSwap )  x = endian::Convert(x);
+                                }
+                                else
+                                {
+                                    assert(false);
+                                }
+                            }
+                        }
+                    }
+                }, A );
+            }
+        }
+        else
+        {
+            //
+            // Lambda Used to write the fields
+            // (unsigned values are written as hex, signed as decimal and floats with their shortest form
+            // or with the precision of the column)
+            //
+            auto Numerics = [&]( details::field_info& FieldInfo, auto Value ) noexcept
+            {
+                using T = std::decay_t<decltype(Value)>;
+                char* pDest = &m_Memory[m_iMemOffet];
+
+                FieldInfo.m_iData = m_iMemOffet;
+                if constexpr ( std::is_floating_point_v<T> )
+                {
+                    FieldInfo.m_Width = format::Float( pDest, m_Memory.size() - m_iMemOffet, Value, FieldInfo.m_IntWidth, Column.m_FloatFormat, Column.m_FloatDigits );
+                }
+                else
+                {
+                    if constexpr ( std::is_signed_v<T> ) FieldInfo.m_Width = format::Signed( pDest, Value );
+                    else                                 FieldInfo.m_Width = format::Hex( pDest, Value );
+                    FieldInfo.m_IntWidth = FieldInfo.m_Width;
+                }
+                m_iMemOffet += 1 + FieldInfo.m_Width;
+            };
+
+            //
+            // Write to a buffer the data
+            //
+            for( auto& A : Args )
+            {
+                auto& Field = Column.m_FieldInfo.emplace_back(); 
+
+                std::visit( [&]( auto p ) constexpr
+                {
+                    using t = std::decay_t<decltype(p)>;
+                            if constexpr ( std::is_same_v<t,std::uint8_t*>      ) Numerics( Field, static_cast<std::uint64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::uint16_t*>     ) Numerics( Field, static_cast<std::uint64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::uint32_t*>     ) Numerics( Field, static_cast<std::uint64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::uint64_t*>     ) Numerics( Field, *p );
+                    else    if constexpr ( std::is_same_v<t,bool*>              ) Numerics( Field, static_cast<std::int64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::int8_t*>       ) Numerics( Field, static_cast<std::int64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::int16_t*>      ) Numerics( Field, static_cast<std::int64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::int32_t*>      ) Numerics( Field, static_cast<std::int64_t>(*p) );
+                    else    if constexpr ( std::is_same_v<t,std::int64_t*>      ) Numerics( Field, *p );
+                    else    if constexpr ( std::is_same_v<t,float*>             ) 
+                            { 
+                                // The reader only knows infinity and NaN by their bits
+                                if( (m_File.m_States.m_isSaveFloats 
+                                 || Column.m_FloatFormat) && std::isfinite(*p) )    Numerics( Field, *p );
+                                else                                                Numerics( Field, static_cast<std::uint64_t>(reinterpret_cast<std::uint32_t&>(*p)) ); 
+                            }
+                    else    if constexpr ( std::is_same_v<t,double*>            ) 
+                            { 
+                                // The reader only knows infinity and NaN by their bits
+                                if( (m_File.m_States.m_isSaveFloats 
+                                 || Column.m_FloatFormat) && std::isfinite(*p) )    Numerics( Field, *p );
+                                else                                                Numerics( Field, reinterpret_cast<std::uint64_t&>(*p) ); 
+                            }
+                    else    if constexpr ( std::is_same_v<t, std::string*> || std::is_same_v<t, std::string_view*> || std::is_same_v<t, const char*> )
+                            {
+                                std::string_view View;
+                                if constexpr (std::is_same_v<t, const char*>) { if( p ) View = p; }   // A null string is written as an empty one
+                                else                                          View = *p;
+                                Field.m_iData = m_iMemOffet;
+
+                                m_Memory[m_iMemOffet++] = '"';
+                                if( View.size() ) memcpy( &m_Memory[m_iMemOffet], View.data(), View.size() );
+                                m_iMemOffet += static_cast<int>(View.size());
+                                m_Memory[m_iMemOffet++] = '"';
+                                m_Memory[m_iMemOffet++] = 0;
+
+                                Field.m_Width = m_iMemOffet - Field.m_iData - 1;
+                            }
+                    else    if constexpr (std::is_same_v<t, std::wstring*> || std::is_same_v<t, std::u16string_view*>)
+                            {
+                                using char_t = typename std::remove_pointer_t<t>::value_type;
+                                Field.m_iData = m_iMemOffet;
+
+                                m_Memory[m_iMemOffet++] = '"';
+                                m_iMemOffet += details::wstring_to_ascii_escape( &m_Memory[m_iMemOffet], std::basic_string_view<char_t>{ *p } );
+                                m_Memory[m_iMemOffet++] = '"';
+                                m_Memory[m_iMemOffet++] = 0;
+
+                                Field.m_Width = m_iMemOffet - Field.m_iData - 1;
+                            }
+                    else
+                    { 
+                        assert(false); 
+                    }
+                }, A );
+
+                //
+                // A value that is the same as the one above it is written as ^ (never in the first
+                // line of a block, so the rows that the .idx points at always have their values)
+                //
+                if( m_File.m_States.m_isWriteRepeats && Column.m_nTypes != -1 )
+                {
+                    const int iType  = static_cast<int>( &A - Args.data() );
+                    const int iField = static_cast<int>( Column.m_FieldInfo.size() ) - 1;
+                    if( iField >= Column.m_nTypes )
+                    {
+                        const auto& Above = Column.m_FieldInfo[ Column.m_iRepeatSource[iType] ];
+                        if( Above.m_Width == Field.m_Width && std::memcmp( &m_Memory[Above.m_iData], &m_Memory[Field.m_iData], Field.m_Width ) == 0 )
+                        {
+                            m_iMemOffet = Field.m_iData;
+                            m_Memory[m_iMemOffet++] = '^';
+                            m_Memory[m_iMemOffet++] = 0;
+                            Field.m_Width    = 1;
+                            Field.m_IntWidth = 1;
+                            continue;
+                        }
+                    }
+                    Column.m_iRepeatSource[iType] = iField;
+                }
+            }
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Updates the widths of the columns with the block of text lines that is about to be
+    //      written. The widths only grow from one block to the next.
+    //------------------------------------------------------------------------------
+    void stream::ComputeTextWidths( void ) noexcept
+    {
+        //
+        // Initialize the columns
+        //
+        if( m_iLine <= m_nLinesBeforeFileWrite )
+        {
+            for( int i=0; i<m_nColumns; ++i )
+            {
+                auto& Column            = m_Columns[i];
+                
+                Column.m_FormatTotalSubColumns = 0;
+                Column.m_FormatWidth           = 0;
+
+                if( Column.m_nTypes == -1 )
+                {
+                    Column.m_SubColumn.clear();
+                    Column.m_SubColumn.resize(Column.m_SubColumn.size() + 2);
+                }
+                else
+                {
+                    Column.m_SubColumn.clear();
+                    Column.m_SubColumn.resize(Column.m_SubColumn.size() + Column.m_nTypes);
+                }
+            }
+        }
+
+        // Labels have no columns
+        if( m_nColumns == -1 )
+            return;
+
+        //
+        // Compute the width for each column also for each of its types
+        //
+        for( int i = 0; i<m_nColumns; ++i )
+        {
+            auto& Column        = m_Columns[i];
+
+            if( Column.m_nTypes == -1 )
+            {
+                auto& TypeSubColumn   = Column.m_SubColumn[0];
+                auto& ValuesSubColumn = Column.m_SubColumn[1];
+
+                //
+                // Compute the width with all the fields 
+                //
+                for( auto& DField : Column.m_DynamicFields )
+                {
+                    {
+                        // Add the spaces between each field
+                        DField.m_FormatWidth = (DField.m_nTypes-1) * m_nSpacesBetweenFields;
+
+                        // count all the widths of the types
+                        for( int n=0; n<DField.m_nTypes; n++ )
+                        {
+                            const auto& FieldInfo   = Column.m_FieldInfo[ DField.m_iField + n ];
+                            DField.m_FormatWidth += FieldInfo.m_Width;
+                        }
+
+                        ValuesSubColumn.m_FormatWidth = std::max( ValuesSubColumn.m_FormatWidth, DField.m_FormatWidth );
+                    }
+
+                    // Dynamic types must include the type inside the column
+                    if( DField.m_UserType.m_Value )
+                    {
+                        auto p = getUserType(DField.m_UserType);
+                        assert(p);
+                        TypeSubColumn.m_FormatWidth = std::max( TypeSubColumn.m_FormatWidth, p->m_NameLength + 1 ); // includes ";"
+                    }
+                    else
+                    {
+                        TypeSubColumn.m_FormatWidth = std::max( TypeSubColumn.m_FormatWidth, DField.m_nTypes + 1 ); // includes ":"
+                    }
+                }
+
+                //
+                // Handle the column name as well 
+                //
+                Column.m_FormatNameWidth = Column.m_NameLength + 1 + 1; // includes ":?"
+                Column.m_FormatWidth           = std::max( Column.m_FormatWidth, ValuesSubColumn.m_FormatWidth + TypeSubColumn.m_FormatWidth + m_nSpacesBetweenFields );
+                Column.m_FormatTotalSubColumns = std::max( Column.m_FormatTotalSubColumns, Column.m_FormatWidth );
+                Column.m_FormatWidth           = std::max( Column.m_FormatWidth, Column.m_FormatNameWidth );
+            }
+            else
+            {
+                //
+                // For any sub-columns that are floats we need to compute the max_int first
+                //
+                for( int it =0; it<Column.m_nTypes; ++it )
+                {
+                    if( Column.m_SystemTypes[it] != 'f' && Column.m_SystemTypes[it] != 'F' )
+                        continue;
+                    
+                    auto& SubColumn = Column.m_SubColumn[it];
+                    for( int iff = it; iff < Column.m_FieldInfo.size(); iff += Column.m_nTypes )
+                    {
+                        auto& Field = Column.m_FieldInfo[iff];
+                        SubColumn.m_FormatIntWidth = std::max( SubColumn.m_FormatIntWidth, Field.m_IntWidth );
+                    }
+                }
+
+                //
+                // Computes the sub-columns sizes
+                //
+                for( auto& Field : Column.m_FieldInfo )
+                {
+                    const int iSubColumn = static_cast<int>(&Field - Column.m_FieldInfo.data()) % Column.m_nTypes; //Column.m_FieldInfo.getIndexByEntry(Field)%Column.m_nTypes;
+                    auto&     SubColumn  = Column.m_SubColumn[iSubColumn];
+                    if( Column.m_SystemTypes[iSubColumn] == 'f' || Column.m_SystemTypes[iSubColumn] == 'F' )
+                    {
+                        const int Width = (Field.m_Width - Field.m_IntWidth) + SubColumn.m_FormatIntWidth;
+                        SubColumn.m_FormatWidth = std::max( SubColumn.m_FormatWidth, Width );
+                    }
+                    else
+                    {
+                        SubColumn.m_FormatWidth = std::max( SubColumn.m_FormatWidth, Field.m_Width );
+                    }
+                }
+
+                //
+                // Compute the columns sizes
+                //
+
+                // Add all the spaces between fields
+                Column.m_FormatWidth = (Column.m_nTypes - 1) * m_nSpacesBetweenFields;
+
+                assert( Column.m_nTypes == Column.m_SubColumn.size() );
+                // Add all the sub-columns widths
+                for( auto& Subcolumn : Column.m_SubColumn )
+                {
+                    Column.m_FormatWidth += Subcolumn.m_FormatWidth;
+                }
+
+                //
+                // Handle the column name as well 
+                //
+                Column.m_FormatNameWidth = Column.m_NameLength + 1; // includes ":"
+                if( Column.m_UserType.m_Value )
+                {
+                    auto p = getUserType( Column.m_UserType );
+                    assert(p);
+                    Column.m_FormatNameWidth += p->m_NameLength;
+                }
+                else
+                {
+                    Column.m_FormatNameWidth += Column.m_nTypes; 
+                }
+
+                // Decide the final width for this column
+                Column.m_FormatTotalSubColumns = std::max( Column.m_FormatTotalSubColumns, Column.m_FormatWidth );
+                Column.m_FormatWidth = std::max( Column.m_FormatWidth, Column.m_FormatNameWidth );
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Remembers where the current record starts, for the .idx sidecar of text files and
+    //      for the footer of binary files. Labels don't have any rows.
+    //------------------------------------------------------------------------------
+    void stream::AddIndexEntry( std::int64_t Offset, bool bLabel ) noexcept
+    {
+        auto& Entry = m_Index.m_Records.emplace_back();
+        Entry.m_Name        = m_Record.m_Name;
+        Entry.m_Offset      = Offset;
+        Entry.m_Count       = bLabel ? 0 : m_Record.m_Count;
+        Entry.m_iRowOffset  = static_cast<int>(m_Index.m_RowOffsets.size());
+        Entry.m_bLabel      = bLabel;
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes the header of a text record: the pending user types, the [ Name : Count ] line
+    //      and the { Name:Types } line. The aligned layout pads the types to the width of their
+    //      column (see ComputeTextWidths), the compact one has a single space between them.
+    //      Labels are just their @[ Name ] line.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteRecordHeader( bool bAligned ) noexcept
+    {
+        if( m_nColumns == -1 )
+        {
+            if( m_File.m_States.m_isWriteIndex )
+                AddIndexEntry( m_File.Tell(), true );
+
+            return m_File.WriteFmtStr( "\n@[ %s ]\n", m_Record.m_Name.data() );
+        }
+
+        //
+        // Write any pending user_types types
+        //
+        if( auto Err = WriteUserTypes(); Err )
+            return Err;
+
+        //
+        // Remember where the record starts for the .idx sidecar
+        //
+        if( m_File.m_States.m_isWriteIndex )
+            AddIndexEntry( m_File.Tell(), false );
+
+        //
+        // Write header
+        //
+        if( m_Record.m_bWriteCount && m_Record.m_Count == m_UnknownCount )
+        {
+            if( auto Err = m_File.WriteFmtStr( "\n[ %s : ? ]\n", m_Record.m_Name.data() ); Err )
+                return Err;
+        }
+        else if( m_Record.m_bWriteCount )
+        {
+            if( auto Err = m_File.WriteFmtStr( "\n[ %s : %d ]\n", m_Record.m_Name.data(), m_Record.m_Count ); Err )
+                return Err;
+        }
+        else
+        {
+            if( auto Err = m_File.WriteFmtStr( "\n[ %s ]\n", m_Record.m_Name.data() ); Err )
+                return Err;
+        }
+
+        //
+        // Write the types
+        //
+        if( auto Err = m_File.WriteStr( "{ " ); Err )
+            return Err;
+
+        for( int i = 0; i<m_nColumns; ++i )
+        {
+            auto& Column        = m_Columns[i];
+
+            if( Column.m_nTypes == -1 )
+            {
+                if( auto Err = m_File.WriteFmtStr( "%s:?", Column.m_Name.data() ); Err )
+                    return Err;
+            }
+            else if( Column.m_UserType.m_Value )
+            {
+                auto p = getUserType(Column.m_UserType);
+                assert(p);
+
+                if( auto Err = m_File.WriteFmtStr( "%s;%s", Column.m_Name.data(), p->m_Name.data() ); Err )
+                    return Err;
+            }
+            else
+            {
+                if( auto Err = m_File.WriteFmtStr( "%s:%s", Column.m_Name.data(), Column.m_SystemTypes.data() ); Err )
+                    return Err;
+            }
+
+            // Write spaces to reach the end of the column
+            if( bAligned && Column.m_FormatWidth > Column.m_FormatNameWidth )
+            {
+                if( auto Err = m_File.WriteChar( ' ', Column.m_FormatWidth - Column.m_FormatNameWidth ); Err )
+                    return Err;
+            }
+
+            // Write spaces between columns
+            if( (i+1) != m_nColumns )
+            {
+                if( auto Err = m_File.WriteChar( ' ', bAligned ? m_nSpacesBetweenColumns : 1 ); Err ) 
+                    return Err;
+            }
+        }
+
+        return m_File.WriteStr( " }\n" );
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes a block of text lines (and the record header when it is the first block)
+    //      using the widths from ComputeTextWidths.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteTextBlock( void ) noexcept
+    {
+        //
+        // If it is a label just print it
+        //
+        if(m_nColumns == -1)
+            return WriteRecordHeader( true );
+
+        //
+        // Save the record info
+        //
+        if( m_iLine <= m_nLinesBeforeFileWrite )
+        {
+            if( auto Err = WriteRecordHeader( true ); Err )
+                return Err;
+
+            //
+            // Write a nice underline for the columns
+            //
+            {
+                if( auto Err = m_File.WriteStr( "//" ); Err )
+                    return Err;
+
+                for( int i = 0; i<m_nColumns; ++i )
+                {
+                    auto& Column  = m_Columns[i];
+
+                    if( auto Err = m_File.WriteChar( '-', Column.m_FormatWidth ); Err )
+                        return Err;
+
+                    // Get ready for the next type
+                    if( (i+1) != m_nColumns) 
+                    {
+                        if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenColumns ); Err ) 
+                            return Err;
+                    }
+                }
+
+                if( auto Err = m_File.WriteChar( '\n' ); Err )
+                    return Err;
+            }
+        }
+
+        //
+        // Print all the data
+        //
+        {
+            int L = m_iLine%m_nLinesBeforeFileWrite;
+            if( L == 0 ) L = m_nLinesBeforeFileWrite;
+
+            // Every block but the first one starts at a row that the .idx sidecar remembers
+            static_assert( m_nIndexRowStep == m_nLinesBeforeFileWrite );
+            if( m_File.m_States.m_isWriteIndex && (m_iLine - L) > 0 )
+                m_Index.m_RowOffsets.push_back( m_File.Tell() );
+
+            for( int l = 0; l<L; ++l )
+            {
+                // Prefix with two spaces to align things
+                if( auto Err = m_File.WriteChar( ' ', 2 ); Err ) 
+                    return Err;
+
+                for( int i = 0; i<m_nColumns; ++i )
+                {
+                    const auto& Column        = m_Columns[i];
+
+                    if( Column.m_nTypes == -1 )
+                    {
+                        const auto& DynamicFields = Column.m_DynamicFields[l];
+
+                        //
+                        // First write the type
+                        //
+                        if( DynamicFields.m_UserType.m_Value ) 
+                        {
+                            auto p = getUserType( DynamicFields.m_UserType );
+                            assert(p);
+                            if( auto Err = m_File.WriteFmtStr( ";%s", p->m_Name.data() ); Err )
+                                return Err;
+
+                            // Fill spaces to reach the next column
+                            if( auto Err = m_File.WriteChar( ' ', Column.m_SubColumn[0].m_FormatWidth - p->m_NameLength -1 + m_nSpacesBetweenFields ); Err )
+                                return Err;
+                        }
+                        else
+                        {
+                            if( auto Err = m_File.WriteFmtStr( ":%s", DynamicFields.m_SystemTypes.data() ); Err )
+                                return Err;
+
+                            // Fill spaces to reach the next column
+                            if( auto Err = m_File.WriteChar( ' ', Column.m_SubColumn[0].m_FormatWidth - DynamicFields.m_nTypes -1 + m_nSpacesBetweenFields ); Err )
+                                return Err;
+                        }
+
+                        //
+                        // Then write the values
+                        //
+                        for( int n=0; n<DynamicFields.m_nTypes; ++n )
+                        {
+                            const auto& FieldInfo   = Column.m_FieldInfo[ DynamicFields.m_iField + n ];
+                    
+                            if( auto Err = m_File.WriteStr( std::string{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
+                                return Err;
+                                
+                            // Get ready for the next type
+                            if( (DynamicFields.m_nTypes-1) != n)
+                            {
+                                if(auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenFields ); Err )
+                                    return Err;
+                            }
+                        }
+
+                        // Pad the width to match the columns width
+                        if( auto Err = m_File.WriteChar( ' ',    Column.m_FormatWidth 
+                                                               - DynamicFields.m_FormatWidth
+                                                               - Column.m_SubColumn[0].m_FormatWidth 
+                                                               - m_nSpacesBetweenFields  ); Err )
+                            return Err;
+                    }
+                    else
+                    {
+                        const auto  Center      = Column.m_FormatWidth - Column.m_FormatTotalSubColumns;
+
+                        if( (Center>>1) > 0 )
+                        {
+                            if ( auto Err = m_File.WriteChar(' ', Center >> 1); Err) 
+                                return Err;
+                        }
+                            
+
+                        for( int n=0; n<Column.m_nTypes; ++n )
+                        {
+                            const auto  Index       = l*Column.m_nTypes + n;
+                            const auto& FieldInfo   = Column.m_FieldInfo[ Index ];
+                            const auto& SubColumn   = Column.m_SubColumn[ n ];
+
+                            if( Column.m_SystemTypes[n] == 'f' || Column.m_SystemTypes[n] == 'F' )
+                            {
+                                // point align Right align
+                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatIntWidth - FieldInfo.m_IntWidth ); Err )
+                                    return Err;
+
+                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
+                                    return Err;
+
+                                // Write spaces to reach the next sub-column
+                                int nSpaces = SubColumn.m_FormatWidth - ( SubColumn.m_FormatIntWidth + FieldInfo.m_Width - FieldInfo.m_IntWidth );
+                                if( auto Err = m_File.WriteChar( ' ', nSpaces ); Err ) 
+                                    return Err;
+                            }
+                            else if( Column.m_SystemTypes[n] == 's' || Column.m_SystemTypes[n] == 'S')
+                            {
+                                // Left align
+                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
+                                    return Err;
+
+                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatWidth - FieldInfo.m_Width ); Err )
+                                    return Err;
+                            }
+                            else
+                            {
+                                // Right align
+                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatWidth - FieldInfo.m_Width ); Err )
+                                    return Err;
+
+                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
+                                    return Err;
+                            }
+
+                            // Write spaces to reach the next sub-column
+                            if( (n+1) != Column.m_nTypes ) 
+                            {
+                                if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenFields ); Err ) 
+                                    return Err;
+                            }
+                        }
+
+                        // Add spaces to finish this column
+                        if( Center > 0 )
+                        {
+                            if ( auto Err = m_File.WriteChar(' ', Center - (Center >> 1)); Err ) 
+                                return Err;
+                        }
+                            
+                    }
+
+                    // Write spaces to reach the next column
+                    if((i+1) != m_nColumns) 
+                    {
+                        if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenColumns ); Err ) 
+                            return Err;
+                    }
+                }
+
+                // End the line
+                if( auto Err = m_File.WriteStr( "\n" ); Err )
+                    return Err;
+            }
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    void stream::StartTextPipeline( void ) noexcept
+    {
+        m_pPipeline = std::make_unique<details::text_pipeline>();
+
+        // Leave a core for the user thread
+        const int nWorkers = std::clamp( static_cast<int>(std::thread::hardware_concurrency()) - 1, 1, 4 );
+        for( int i=0; i<nWorkers; ++i )
+        {
+            m_pPipeline->m_Workers.emplace_back( [&Pipeline = *m_pPipeline]
+            {
+                std::unique_lock Lock( Pipeline.m_Mutex );
+                while( true )
+                {
+                    Pipeline.m_WorkReady.wait( Lock, [&]{ return Pipeline.m_bQuit || Pipeline.m_Pending.empty() == false; } );
+                    if( Pipeline.m_Pending.empty() ) 
+                        return;
+
+                    auto& Job = *Pipeline.m_Pending.front();
+                    Pipeline.m_Pending.pop_front();
+                    Lock.unlock();
+
+                    Job.m_Output.clear();
+                    Job.m_Error = Job.m_Formatter.WriteTextBlock();
+
+                    Lock.lock();
+                    Job.m_bDone = true;
+                    Pipeline.m_JobDone.notify_all();
+                }
+            });
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Hands the current block of text lines (after ComputeTextWidths) to the workers.
+    //      The columns keep their definitions and widths for the next block.
+    //------------------------------------------------------------------------------
+    xerr stream::SubmitTextBlock( void ) noexcept
+    {
+        auto& Pipeline = *m_pPipeline;
+
+        // Don't let the user get too far ahead of the file
+        if( auto Err = FlushTextBlocks( 2 * Pipeline.m_Workers.size() - 1 ); Err )
+            return Err;
+
+        std::unique_ptr<details::text_pipeline::job> pJob;
+        if( Pipeline.m_FreeJobs.empty() )
+        {
+            pJob = std::make_unique<details::text_pipeline::job>();
+            pJob->m_Formatter.m_File.m_pOutput = &pJob->m_Output;
+        }
+        else
+        {
+            pJob = std::move( Pipeline.m_FreeJobs.back() );
+            Pipeline.m_FreeJobs.pop_back();
+        }
+
+        //
+        // Give the block to the job
+        //
+        auto& Formatter = pJob->m_Formatter;
+        Formatter.m_Columns         = m_Columns;
+        Formatter.m_Record          = m_Record;
+        Formatter.m_nColumns        = m_nColumns;
+        Formatter.m_iLine           = m_iLine;
+        Formatter.m_File.m_States   = m_File.m_States;
+        Formatter.m_Index.clear();
+        Formatter.m_Memory.swap( m_Memory );
+
+        // The first block writes the pending user types so after this they are saved
+        const bool bFirstBlock = m_iLine <= m_nLinesBeforeFileWrite && m_nColumns != -1;
+        if( bFirstBlock || Formatter.m_UserTypes.size() != m_UserTypes.size() )
+        {
+            Formatter.m_UserTypes   = m_UserTypes;
+            Formatter.m_UserTypeMap = m_UserTypeMap;
+        }
+
+        if( bFirstBlock )
+        {
+            for( auto& UserType : m_UserTypes )
+                UserType.m_bAlreadySaved = true;
+        }
+
+        {
+            std::scoped_lock Lock( Pipeline.m_Mutex );
+            Pipeline.m_Pending.push_back( pJob.get() );
+        }
+        Pipeline.m_WorkReady.notify_one();
+        Pipeline.m_InFlight.push_back( std::move(pJob) );
+
+        // Write what ever is ready
+        return FlushTextBlocks( Pipeline.m_InFlight.size() );
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes to the file the blocks that are done, in order. It waits for the oldest ones
+    //      until no more than nMaxInFlight are left (zero waits for all of them).
+    //------------------------------------------------------------------------------
+    xerr stream::FlushTextBlocks( std::size_t nMaxInFlight ) noexcept
+    {
+        if( m_pPipeline == nullptr )
+            return {};
+
+        auto& Pipeline = *m_pPipeline;
+        while( Pipeline.m_InFlight.empty() == false )
+        {
+            auto& Job = *Pipeline.m_InFlight.front();
+            {
+                std::unique_lock Lock( Pipeline.m_Mutex );
+                if( Job.m_bDone == false )
+                {
+                    if( Pipeline.m_InFlight.size() <= nMaxInFlight )
+                        break;
+
+                    Pipeline.m_JobDone.wait( Lock, [&]{ return Job.m_bDone; } );
+                }
+            }
+
+            xerr Error = std::move( Job.m_Error );
+            Job.m_Error.clear();
+            Job.m_bDone = false;
+
+            if( !Error )
+                Error = WriteLaidOut( Job.m_Output, Job.m_Formatter.m_Index );
+
+            Pipeline.m_FreeJobs.push_back( std::move( Pipeline.m_InFlight.front() ) );
+            Pipeline.m_InFlight.pop_front();
+
+            if( Error ) 
+                return Error;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes what another stream laid out in memory and takes its .idx entries. The buffer is
+    //      written in pieces, stopping at the offsets that the sidecar needs since only the file
+    //      knows where they end up (text files may translate new lines).
+    //------------------------------------------------------------------------------
+    xerr stream::WriteLaidOut( std::string_view Output, details::record_index& Index ) noexcept
+    {
+        std::vector<std::int64_t*> Offsets;
+        for( auto& Entry  : Index.m_Records    ) Offsets.push_back( &Entry.m_Offset );
+        for( auto& Offset : Index.m_RowOffsets ) Offsets.push_back( &Offset );
+        std::stable_sort( Offsets.begin(), Offsets.end(), []( const std::int64_t* pA, const std::int64_t* pB ){ return *pA < *pB; } );
+
+        std::int64_t iStart = 0;
+        for( auto pOffset : Offsets )
+        {
+            if( auto Err = m_File.WriteStr( Output.substr( static_cast<std::size_t>(iStart), static_cast<std::size_t>(*pOffset - iStart) ) ); Err )
+                return Err;
+
+            iStart   = *pOffset;
+            *pOffset = m_File.Tell();
+        }
+
+        if( auto Err = m_File.WriteStr( Output.substr( static_cast<std::size_t>(iStart) ) ); Err )
+            return Err;
+
+        for( auto& Entry : Index.m_Records )
+        {
+            Entry.m_iRowOffset += static_cast<int>(m_Index.m_RowOffsets.size());
+            m_Index.m_Records.push_back( Entry );
+        }
+        m_Index.m_RowOffsets.insert( m_Index.m_RowOffsets.end(), Index.m_RowOffsets.begin(), Index.m_RowOffsets.end() );
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Each job writes its records into a stream of its own in memory, the jobs run on worker
+    //      threads and their output goes to the file in job order. The user types are written
+    //      before the jobs start so each job already has them saved. The ones that the jobs add
+    //      get their index from this stream (see shared_user_types) and are written right before
+    //      the output of the first job that is written after they were added, so binary files
+    //      agree on their indices. When reading (or with tee outputs) the jobs are just called
+    //      in order with this stream.
+    //------------------------------------------------------------------------------
+    xerr stream::RecordsParallel( std::size_t nJobs, const std::function<void( std::size_t iJob, stream& File, xerr& Error )>& Callback ) noexcept
+    {
+        // The tee outputs only get what goes through this stream so then the jobs run here in order
+        if( m_File.m_States.m_isReading || m_TeeOutputs.empty() == false )
+        {
+            for( std::size_t i = 0; i < nJobs; ++i )
+            {
+                xerr Error;
+                Callback( i, *this, Error );
+                if( Error ) return Error;
+            }
+            return {};
+        }
+
+        //
+        // Whatever came before the jobs goes first
+        //
+        if( auto Err = FlushTextBlocks( 0 ); Err )
+            return Err;
+
+        if( auto Err = WriteUserTypes(); Err )
+            return Err;
+
+        struct job
+        {
+            stream          m_Stream    {};
+            std::string     m_Output    {};
+            xerr            m_Error     {};
+        };
+
+        details::shared_user_types          SharedTypes { *this };
+        const std::size_t                   nWorkers    = std::clamp<std::size_t>( std::thread::hardware_concurrency(), 1, std::max<std::size_t>( nJobs, 1 ) );
+        const std::size_t                   nMaxAhead   = 2 * nWorkers;     // Jobs that can be done but not written yet
+        std::vector<std::unique_ptr<job>>   Jobs( nJobs );
+        std::mutex                          Mutex;
+        std::condition_variable             JobDone;
+        std::condition_variable             SlotFree;
+        std::size_t                         iNextJob    = 0;
+        std::size_t                         iWritten    = 0;
+        bool                                bQuit       = false;
+
+        auto Worker = [&]
+        {
+            while( true )
+            {
+                std::size_t iJob;
+                {
+                    std::unique_lock Lock( Mutex );
+                    SlotFree.wait( Lock, [&]{ return bQuit || iNextJob >= nJobs || iNextJob < iWritten + nMaxAhead; } );
+                    if( bQuit || iNextJob >= nJobs ) return;
+                    iJob = iNextJob++;
+                }
+
+                auto  pJob   = std::make_unique<job>();
+                auto& Stream = pJob->m_Stream;
+                Stream.m_File.m_pOutput = &pJob->m_Output;
+                Stream.m_File.m_States  = m_File.m_States;
+                Stream.m_Memory.resize( 2048 );
+                {
+                    std::scoped_lock Lock( SharedTypes.m_Mutex );
+                    Stream.m_UserTypes      = m_UserTypes;
+                    Stream.m_UserTypeMap    = m_UserTypeMap;
+                }
+
+                // This stream writes the user types, the ones that other jobs added too
+                for( auto& UserType : Stream.m_UserTypes ) UserType.m_bAlreadySaved = true;
+                Stream.m_pSharedUserTypes = &SharedTypes;
+
+                // Each job aligns its records with a temporary file of its own
+                if( m_File.m_States.m_isWriteAlignRecord )
+                {
+                    if( auto pSpill = std::tmpfile(); pSpill ) Stream.m_Spill.setup( *pSpill, m_Spill.m_States );
+                    else pJob->m_Error = xerr::create_f< state, "Fail to create the temporary file used to align the records" >();
+                }
+
+                if( !pJob->m_Error )
+                    Callback( iJob, Stream, pJob->m_Error );
+
+                {
+                    std::scoped_lock Lock( Mutex );
+                    Jobs[iJob] = std::move( pJob );
+                }
+                JobDone.notify_all();
+            }
+        };
+
+        std::vector<std::thread> Workers;
+        for( std::size_t i = 0; i < nWorkers; ++i )
+            Workers.emplace_back( Worker );
+
+        //
+        // Write the jobs in order as they get done
+        //
+        xerr Error;
+        for( std::size_t i = 0; i < nJobs; ++i )
+        {
+            std::unique_ptr<job> pJob;
+            {
+                std::unique_lock Lock( Mutex );
+                JobDone.wait( Lock, [&]{ return Jobs[i] != nullptr; } );
+                pJob = std::move( Jobs[i] );
+            }
+
+            if( Error = std::move( pJob->m_Error ); Error )
+                break;
+
+            // The user types that the jobs added so far (this one included) go before it
+            {
+                std::scoped_lock Lock( SharedTypes.m_Mutex );
+                Error = WriteUserTypes();
+            }
+            if( Error ) 
+                break;
+
+            if( Error = WriteLaidOut( pJob->m_Output, pJob->m_Stream.m_Index ); Error )
+                break;
+
+            {
+                std::scoped_lock Lock( Mutex );
+                iWritten = i + 1;
+            }
+            SlotFree.notify_all();
+        }
+
+        {
+            std::scoped_lock Lock( Mutex );
+            bQuit = true;
+        }
+        SlotFree.notify_all();
+
+        for( auto& W : Workers )
+            W.join();
+
+        return Error;
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::WriteLine( void ) noexcept
+    {
+        // The tee outputs finish the same line
+        for( auto pTee : m_TeeOutputs )
+        {
+            if( auto Err = pTee->WriteLine(); Err )
+                return Err;
+        }
+
+        return CommitLine();
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Finishes the current line of this stream (not of its tee outputs). The lines are
+    //      staged and written in blocks of m_nLinesBeforeFileWrite.
+    //------------------------------------------------------------------------------
+    xerr stream::CommitLine( void ) noexcept
+    {
+        assert( m_File.m_States.m_isReading == false );
+
+        // Make sure that the user_types don't try to write more lines than expected
+        assert( m_iLine < m_Record.m_Count );
+
+        //
+        // Increment the line count
+        // and reset the column index
+        //
+        m_iLine++;
+        m_iColumn   = 0;
+
+        //
+        // Compact text has nothing to align so each line is written right away
+        //
+        if( m_File.m_States.m_isWriteCompact )
+            return WriteCompactLine();
+
+        //
+        // We will wait writing the line if we can so we can format
+        //
+        if( (m_iLine < m_Record.m_Count && (m_iLine%m_nLinesBeforeFileWrite) != 0) )
+        {
+            return {};
+        }
+
+
+        //
+        // Lets handle the binary case first
+        //
+        if( m_File.m_States.m_isBinary )
+        {
+            if( m_iLine <= m_nLinesBeforeFileWrite )
+            {
+                //
+                // Write any pending user_types types
+                //
+                if( auto Err = WriteUserTypes(); Err)
+                    return Err;
+            
+                //
+                // Write record header
+                //
+
+                // Remember where the record starts for the footer
+                if( m_File.m_States.m_isWriteIndex )
+                    AddIndexEntry( m_File.Tell(), m_nColumns == -1 );
+
+                // First handle the case that is a label  
+                if( m_nColumns == -1 )
+                {
+                    if (auto Err = m_File.WriteChar('@'); Err)
+                        return Err;
+
+                    if (auto Err = m_File.WriteChar('['); Err)
+                        return Err;
+
+                    if (auto Err = m_File.WriteStr({ m_Record.m_Name.data(), std::strlen(m_Record.m_Name.data()) + 1 }); Err )
+                        return Err;
+
+                    goto CLEAR;
+                }
+
+                if( auto Err = m_File.WriteChar( '[' ); Err )
+                    return Err;
+
+                if( auto Err = m_File.WriteStr( { m_Record.m_Name.data(), std::strlen( m_Record.m_Name.data() )+1 } ); Err )
+                    return Err;
+
+                // Streamed records patch the count after the last line
+                if( m_Record.m_Count == m_UnknownCount )
+                    m_Record.m_iCountOffset = m_File.Tell();
+
+                int Count = m_File.m_States.m_isEndianSwap ? endian::Convert( m_Record.m_Count ) : m_Record.m_Count;
+                if( auto Err = m_File.Write( Count ); Err )
+                    return Err;
+
+                //
+                // Write types
+                //
+                {
+                    std::uint8_t nColumns = static_cast<std::uint8_t>(m_nColumns);
+                    if( auto Err = m_File.Write( nColumns ); Err ) 
+                        return Err;
+                }
+
+                for( int i=0; i<m_nColumns; ++i )
+                {
+                    auto& Column = m_Columns[i];
+
+                    if( auto Err = m_File.WriteStr( std::string_view{ Column.m_Name.data(), static_cast<std::size_t>(Column.m_NameLength) } ); Err )
+                        return Err;
+
+                    if( Column.m_nTypes == -1 )
+                    {
+                        if( auto Err = m_File.WriteChar( '?' ); Err )
+                            return Err;
+                    }
+                    else
+                    {
+                        if( Column.m_UserType.m_Value )
+                        {
+                            if( auto Err = m_File.WriteChar( ';' ); Err )
+                                return Err;
+
+                            std::uint8_t Index = static_cast<std::uint8_t>(getUserType(Column.m_UserType) - m_UserTypes.data());  // m_UserTypes.getIndexByEntry<std::uint8_t>( *getUserType(Column.m_UserType) );
+                            if( auto Err = m_File.Write( Index ); Err )
+                                return Err;
+                        }
+                        else
+                        {
+                            if( auto Err = m_File.WriteChar( ':' ); Err )
+                                return Err;
+
+                            if( auto Err = m_File.WriteStr( { Column.m_SystemTypes.data(), static_cast<std::size_t>(Column.m_nTypes + 1) } ); Err )
                                 return Err;
                         }
                     }
@@ -1386,9 +4196,18 @@ namespace xtextfile
 
             //
             // Dump line info
+            // (with blocks the rows go to memory first since the block starts with their size)
             //
             int L = m_iLine%m_nLinesBeforeFileWrite;
             if( L == 0 ) L = m_nLinesBeforeFileWrite;
+
+            std::string* const pOutput = m_File.m_pOutput;
+            if( m_File.m_States.m_isBlocks )
+            {
+                m_BlockBuffer.clear();
+                m_File.m_pOutput = &m_BlockBuffer;
+            }
+
             for( int l = 0; l<L; ++l )
             {
                 for( int i = 0; i<m_nColumns; ++i )
@@ -1446,432 +4265,509 @@ namespace xtextfile
             }
 
             //
-            // Clear the memory pointer
+            // The block goes out with its size and row count in front (in the endian of the file)
+            // Compressed blocks also have the size of the rows, a block that does not get smaller
+            // is saved as it is.
             //
-            goto CLEAR ;
-        }
-
-        //
-        // Initialize the columns
-        //
-        if( m_iLine <= m_nLinesBeforeFileWrite )
-        {
-            for( int i=0; i<m_nColumns; ++i )
+            if( m_File.m_States.m_isBlocks )
             {
-                auto& Column            = m_Columns[i];
-                
-                Column.m_FormatTotalSubColumns = 0;
-                Column.m_FormatWidth           = 0;
+                m_File.m_pOutput = pOutput;
 
-                if( Column.m_nTypes == -1 )
-                {
-                    Column.m_SubColumn.clear();
-                    Column.m_SubColumn.resize(Column.m_SubColumn.size() + 2);
-                }
-                else
+                std::string_view Rows = m_BlockBuffer;
+                if( m_File.m_States.m_isCompressed )
                 {
-                    Column.m_SubColumn.clear();
-                    Column.m_SubColumn.resize(Column.m_SubColumn.size() + Column.m_nTypes);
+                    details::lz::Compress( m_BlockBuffer, m_PackedBlock );
+                    if( m_PackedBlock.size() < m_BlockBuffer.size() ) 
+                        Rows = m_PackedBlock;
                 }
+
+                std::array<std::uint32_t,3> Header{ static_cast<std::uint32_t>(Rows.size()), static_cast<std::uint32_t>(L), static_cast<std::uint32_t>(m_BlockBuffer.size()) };
+                if( m_File.m_States.m_isEndianSwap )
+                    for( auto& V : Header ) V = endian::Convert(V);
+
+                if( auto Err = m_File.Write( Header, m_File.m_States.m_isCompressed ? 12 : 8 ); Err )
+                    return Err;
+
+                if( auto Err = m_File.WriteData( Rows ); Err )
+                    return Err;
             }
+
+            //
+            // Clear the memory pointer
+            //
+            goto CLEAR ;
         }
 
         //
-        // If it is a label just print it
+        // Text lines get aligned so first we need the widths of the columns
         //
-        if(m_nColumns == -1)
+        ComputeTextWidths();
+
+        if( m_File.m_States.m_isWriteAlignRecord && m_Record.m_Count > m_nLinesBeforeFileWrite )
         {
-            if ( auto Err = m_File.WriteFmtStr("\n@[ %s ]\n", m_Record.m_Name.data()); Err)
+            // The widths are only final after the last line so until then the blocks wait in the temporary file
+            if( auto Err = SpillTextBlock(); Err )
+                return Err;
+
+            if( m_iLine < m_Record.m_Count )
+                goto CLEAR;
+
+            if( auto Err = WriteSpilledBlocks(); Err )
+                return Err;
+        }
+        else if( m_pPipeline )
+        {
+            // The worker threads lay out the text while the user keeps writing
+            if( auto Err = SubmitTextBlock(); Err )
+                return Err;
+        }
+        else
+        {
+            if( auto Err = WriteTextBlock(); Err )
                 return Err;
-            
-            //
-            // Clear the memory pointer
-            //
-            goto CLEAR;
         }
 
         //
-        // Compute the width for each column also for each of its types
+        // Reset to get ready for the next block of lines
         //
-        for( int i = 0; i<m_nColumns; ++i )
+        CLEAR:
+        // Clear the columns
+        if( m_iLine < m_Record.m_Count )
         {
-            auto& Column        = m_Columns[i];
-
-            if( Column.m_nTypes == -1 )
+            for( int i=0; i<m_nColumns; ++i )
             {
-                auto& TypeSubColumn   = Column.m_SubColumn[0];
-                auto& ValuesSubColumn = Column.m_SubColumn[1];
+                auto& C = m_Columns[i];
 
-                //
-                // Compute the width with all the fields 
-                //
-                for( auto& DField : Column.m_DynamicFields )
-                {
-                    {
-                        // Add the spaces between each field
-                        DField.m_FormatWidth = (DField.m_nTypes-1) * m_nSpacesBetweenFields;
+                C.m_DynamicFields.clear();
+                C.m_FieldInfo.clear();
+            }
+        }
+        // Clear the memory pointer
+        m_iMemOffet = 0;
 
-                        // count all the widths of the types
-                        for( int n=0; n<DField.m_nTypes; n++ )
-                        {
-                            const auto& FieldInfo   = Column.m_FieldInfo[ DField.m_iField + n ];
-                            DField.m_FormatWidth += FieldInfo.m_Width;
-                        }
+        return {};
+    }
 
-                        ValuesSubColumn.m_FormatWidth = std::max( ValuesSubColumn.m_FormatWidth, DField.m_FormatWidth );
-                    }
+    //------------------------------------------------------------------------------
+    // Description:
+    //      WriteLine for RecordStream. The count of the record becomes known right before its
+    //      last line so WriteLine can flush the last block as usual, then whatever was written
+    //      before knowing the count gets fixed.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteStreamLine( bool bLastLine ) noexcept
+    {
+        for( auto pTee : m_TeeOutputs )
+        {
+            if( auto Err = pTee->WriteStreamLine( bLastLine ); Err )
+                return Err;
+        }
 
-                    // Dynamic types must include the type inside the column
-                    if( DField.m_UserType.m_Value )
-                    {
-                        auto p = getUserType(DField.m_UserType);
-                        assert(p);
-                        TypeSubColumn.m_FormatWidth = std::max( TypeSubColumn.m_FormatWidth, p->m_NameLength + 1 ); // includes ";"
-                    }
-                    else
-                    {
-                        TypeSubColumn.m_FormatWidth = std::max( TypeSubColumn.m_FormatWidth, DField.m_nTypes + 1 ); // includes ":"
-                    }
-                }
+        if( bLastLine == false )
+            return CommitLine();
 
-                //
-                // Handle the column name as well 
-                //
-                Column.m_FormatNameWidth = Column.m_NameLength + 1 + 1; // includes ":?"
-                Column.m_FormatWidth           = std::max( Column.m_FormatWidth, ValuesSubColumn.m_FormatWidth + TypeSubColumn.m_FormatWidth + m_nSpacesBetweenFields );
-                Column.m_FormatTotalSubColumns = std::max( Column.m_FormatTotalSubColumns, Column.m_FormatWidth );
-                Column.m_FormatWidth           = std::max( Column.m_FormatWidth, Column.m_FormatNameWidth );
-            }
-            else
-            {
-                //
-                // For any sub-columns that are floats we need to compute the max_int first
-                //
-                for( int it =0; it<Column.m_nTypes; ++it )
-                {
-                    if( Column.m_SystemTypes[it] != 'f' && Column.m_SystemTypes[it] != 'F' )
-                        continue;
-                    
-                    auto& SubColumn = Column.m_SubColumn[it];
-                    for( int iff = it; iff < Column.m_FieldInfo.size(); iff += Column.m_nTypes )
-                    {
-                        auto& Field = Column.m_FieldInfo[iff];
-                        SubColumn.m_FormatIntWidth = std::max( SubColumn.m_FormatIntWidth, Field.m_IntWidth );
-                    }
-                }
+        m_Record.m_Count = m_iLine + 1;
 
-                //
-                // Computes the sub-columns sizes
-                //
-                for( auto& Field : Column.m_FieldInfo )
-                {
-                    const int iSubColumn = static_cast<int>(&Field - Column.m_FieldInfo.data()) % Column.m_nTypes; //Column.m_FieldInfo.getIndexByEntry(Field)%Column.m_nTypes;
-                    auto&     SubColumn  = Column.m_SubColumn[iSubColumn];
-                    if( Column.m_SystemTypes[iSubColumn] == 'f' || Column.m_SystemTypes[iSubColumn] == 'F' )
-                    {
-                        const int Width = (Field.m_Width - Field.m_IntWidth) + SubColumn.m_FormatIntWidth;
-                        SubColumn.m_FormatWidth = std::max( SubColumn.m_FormatWidth, Width );
-                    }
-                    else
-                    {
-                        SubColumn.m_FormatWidth = std::max( SubColumn.m_FormatWidth, Field.m_Width );
-                    }
-                }
+        if( auto Err = CommitLine(); Err )
+            return Err;
 
-                //
-                // Compute the columns sizes
-                //
+        //
+        // Binary files have a placeholder for the count
+        //
+        if( m_Record.m_iCountOffset )
+        {
+            int Count = m_File.m_States.m_isEndianSwap ? endian::Convert( m_Record.m_Count ) : m_Record.m_Count;
 
-                // Add all the spaces between fields
-                Column.m_FormatWidth = (Column.m_nTypes - 1) * m_nSpacesBetweenFields;
+            // The jobs of RecordsParallel write to memory
+            if( m_File.m_pOutput )
+            {
+                std::memcpy( m_File.m_pOutput->data() + m_Record.m_iCountOffset, &Count, sizeof(Count) );
+            }
+            else
+            {
+                const auto End = m_File.Tell();
 
-                assert( Column.m_nTypes == Column.m_SubColumn.size() );
-                // Add all the sub-columns widths
-                for( auto& Subcolumn : Column.m_SubColumn )
-                {
-                    Column.m_FormatWidth += Subcolumn.m_FormatWidth;
-                }
+                if( auto Err = m_File.SeekSet( m_Record.m_iCountOffset ); Err )
+                    return Err;
 
-                //
-                // Handle the column name as well 
-                //
-                Column.m_FormatNameWidth = Column.m_NameLength + 1; // includes ":"
-                if( Column.m_UserType.m_Value )
-                {
-                    auto p = getUserType( Column.m_UserType );
-                    assert(p);
-                    Column.m_FormatNameWidth += p->m_NameLength;
-                }
-                else
-                {
-                    Column.m_FormatNameWidth += Column.m_nTypes; 
-                }
+                if( auto Err = m_File.Write( Count ); Err )
+                    return Err;
 
-                // Decide the final width for this column
-                Column.m_FormatTotalSubColumns = std::max( Column.m_FormatTotalSubColumns, Column.m_FormatWidth );
-                Column.m_FormatWidth = std::max( Column.m_FormatWidth, Column.m_FormatNameWidth );
+                if( auto Err = m_File.SeekSet( End ); Err )
+                    return Err;
             }
+
+            m_Record.m_iCountOffset = 0;
         }
 
         //
-        // Save the record info
+        // The .idx sidecar wants the real count of the record
         //
-        if( m_iLine <= m_nLinesBeforeFileWrite )
+        if( m_File.m_States.m_isWriteIndex )
         {
-            //
-            // Write any pending user_types types
-            //
-            if( auto Err = WriteUserTypes(); Err )
+            // The entry of the record may still be with the worker threads
+            if( auto Err = FlushTextBlocks( 0 ); Err )
                 return Err;
-        
-            //
-            // Write header
-            //
-            if( m_Record.m_bWriteCount )
+
+            if( m_Index.m_Records.empty() == false )
+                m_Index.m_Records.back().m_Count = m_Record.m_Count;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::OpenConcurrentRecord( const char* pHeaderName, std::size_t Count, bool bArrivalOrder ) noexcept
+    {
+        assert( m_File.m_States.m_isReading == false );
+        assert( m_pConcurrent == nullptr );
+
+        if( auto Err = WriteRecord( pHeaderName, Count ? Count : m_UnknownCount ); Err )
+            return Err;
+
+        m_pConcurrent = std::make_unique<details::concurrent_record>();
+        m_pConcurrent->m_bArrivalOrder = bArrivalOrder;
+        m_pConcurrent->m_bKnownCount   = Count != 0;
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Can be called from any thread. The block is written now if it can be, otherwise it
+    //      waits for the blocks before it (it is moved out of Rows either way).
+    //------------------------------------------------------------------------------
+    xerr stream::SubmitRows( row_block& Rows ) noexcept
+    {
+        assert( m_pConcurrent );
+        auto& Concurrent = *m_pConcurrent;
+
+        std::scoped_lock Lock( Concurrent.m_Mutex );
+        if( Concurrent.m_Error ) return Concurrent.m_Error;
+        if( Rows.getRowCount() == 0 ) return {};
+
+        const auto WriteReady = [&]( row_block& Block ) -> xerr
+        {
+            // The last block of a record with no count must be written knowing it is the last
+            if( Concurrent.m_bKnownCount )
+                return WriteRowBlock( Block, false );
+
+            if( Concurrent.m_bHeld )
             {
-                if( auto Err = m_File.WriteFmtStr( "\n[ %s : %d ]\n", m_Record.m_Name.data(), m_Record.m_Count ); Err )
+                if( auto Err = WriteRowBlock( Concurrent.m_Held, false ); Err )
                     return Err;
             }
-            else
+
+            Concurrent.m_Held  = std::move( Block );
+            Concurrent.m_bHeld = true;
+            return {};
+        };
+
+        xerr Error;
+        if( Concurrent.m_bArrivalOrder )
+        {
+            Error = WriteReady( Rows );
+        }
+        else
+        {
+            const auto iFirstRow = Rows.getFirstRow();
+            if( iFirstRow < Concurrent.m_iNextRow || Concurrent.m_Pending.contains( iFirstRow ) )
+                return Concurrent.m_Error = xerr::create_f< state, "Two row blocks were submitted for the same rows" >();
+
+            Concurrent.m_Pending.emplace( iFirstRow, std::move( Rows ) );
+
+            while( Concurrent.m_Pending.empty() == false && Concurrent.m_Pending.begin()->first == Concurrent.m_iNextRow )
             {
-                if( auto Err = m_File.WriteFmtStr( "\n[ %s ]\n", m_Record.m_Name.data() ); Err )
-                    return Err;
+                auto Node = Concurrent.m_Pending.extract( Concurrent.m_Pending.begin() );
+                Concurrent.m_iNextRow += Node.mapped().getRowCount();
+                if( Error = WriteReady( Node.mapped() ); Error )
+                    break;
             }
+        }
 
-            //
-            // Write the types
-            //
-            {
-                if( auto Err = m_File.WriteStr( "{ " ); Err )
-                    return Err;
+        Rows.clear( 0 );
 
-                for( int i = 0; i<m_nColumns; ++i )
-                {
-                    auto& Column        = m_Columns[i];
+        if( Error ) Concurrent.m_Error = Error;
+        return Error;
+    }
 
-                    if( Column.m_nTypes == -1 )
-                    {
-                        if( auto Err = m_File.WriteFmtStr( "%s:?", Column.m_Name.data() ); Err )
-                            return Err;
-                    }
-                    else
-                    {
-                        if( Column.m_UserType.m_Value )
-                        {
-                            auto p = getUserType(Column.m_UserType);
-                            assert(p);
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Called once all the producers are done.
+    //------------------------------------------------------------------------------
+    xerr stream::EndConcurrentRecord( void ) noexcept
+    {
+        assert( m_pConcurrent );
+        auto& Concurrent = *m_pConcurrent;
+        xerr  Error      = Concurrent.m_Error;
 
-                            if( auto Err = m_File.WriteFmtStr( "%s;%s", Column.m_Name.data(), p->m_Name.data() ); Err )
-                                return Err;
-                        }
-                        else
-                        {
-                            if( auto Err = m_File.WriteFmtStr( "%s:%s", Column.m_Name.data(), Column.m_SystemTypes.data() ); Err )
-                                return Err;
-                        }
-                    }
+        if( !Error && Concurrent.m_Pending.empty() == false )
+            Error = xerr::create_f< state, "Some rows of the concurrent record were never submitted" >();
 
-                    // Write spaces to reach the end of the column
-                    if( Column.m_FormatWidth > Column.m_FormatNameWidth )
-                    {
-                        if( auto Err = m_File.WriteChar( ' ', Column.m_FormatWidth - Column.m_FormatNameWidth ); Err )
-                            return Err;
-                    }
+        if( !Error && Concurrent.m_bHeld )
+            Error = WriteRowBlock( Concurrent.m_Held, true );
 
-                    if( (i+1) != m_nColumns )
-                    {
-                        // Write spaces between columns
-                        if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenColumns ); Err ) 
-                            return Err;
-                    }
-                }
+        if( !Error && Concurrent.m_bKnownCount && m_iLine != m_Record.m_Count )
+            Error = xerr::create_f< state, "The concurrent record got a different number of rows than its count" >();
+
+        m_pConcurrent.reset();
+        return Error;
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes the rows of the block into the record as if the user had written them here.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteRowBlock( row_block& Rows, bool bLastBlock ) noexcept
+    {
+        auto&   Args    = m_pConcurrent->m_Args;
+        int     iField  = 0;
+
+        for( std::size_t iRow = 0; iRow < Rows.m_RowEnds.size(); ++iRow )
+        {
+            if( m_Record.m_Count != m_UnknownCount && m_iLine >= m_Record.m_Count )
+                return xerr::create_f< state, "The concurrent record got more rows than its count" >();
+
+            for( ; iField < Rows.m_RowEnds[iRow]; ++iField )
+            {
+                const auto& Field = Rows.m_Fields[iField];
+
+                Args.clear();
+                for( int i = 0; i < Field.m_nValues; ++i )
+                    Args.push_back( std::visit( []( auto& Value ) -> details::arglist::types { return &Value; }, Rows.m_Values[ Field.m_iValue + i ] ) );
 
-                if( auto Err = m_File.WriteFmtStr( " }\n" ); Err )
+                if( auto Err = WriteColumn( Field.m_UserType, Field.m_pName, Args ); Err )
                     return Err;
             }
 
-            //
-            // Write a nice underline for the columns
-            //
+            if( m_Record.m_Count == m_UnknownCount )
             {
-                if( auto Err = m_File.WriteStr( "//" ); Err )
+                if( auto Err = WriteStreamLine( bLastBlock && iRow + 1 == Rows.m_RowEnds.size() ); Err )
+                    return Err;
+            }
+            else
+            {
+                if( auto Err = WriteLine(); Err )
                     return Err;
+            }
+        }
 
-                for( int i = 0; i<m_nColumns; ++i )
-                {
-                    auto& Column  = m_Columns[i];
+        return {};
+    }
 
-                    if( auto Err = m_File.WriteChar( '-', Column.m_FormatWidth ); Err )
-                        return Err;
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Saves the block of text lines that was just staged into the temporary file. Only one
+    //      block is kept in memory, the rest wait in the file until the widths of the record are final.
+    //------------------------------------------------------------------------------
+    xerr stream::SpillTextBlock( void ) noexcept
+    {
+        for( int i=0; i<m_nColumns; ++i )
+        {
+            auto& Column = m_Columns[i];
 
-                    // Get ready for the next type
-                    if( (i+1) != m_nColumns) 
-                    {
-                        if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenColumns ); Err ) 
-                            return Err;
-                    }
-                }
+            const int nFieldInfos = static_cast<int>(Column.m_FieldInfo.size());
+            if( auto Err = m_Spill.Write( nFieldInfos ); Err )
+                return Err;
 
-                if( auto Err = m_File.WriteChar( '\n' ); Err )
+            if( nFieldInfos )
+            {
+                if( auto Err = m_Spill.Write( *Column.m_FieldInfo.data(), static_cast<int>(sizeof(details::field_info)) * nFieldInfos ); Err )
+                    return Err;
+            }
+
+            const int nDynamicFields = static_cast<int>(Column.m_DynamicFields.size());
+            if( auto Err = m_Spill.Write( nDynamicFields ); Err )
+                return Err;
+
+            if( nDynamicFields )
+            {
+                if( auto Err = m_Spill.Write( *Column.m_DynamicFields.data(), static_cast<int>(sizeof(details::field_type)) * nDynamicFields ); Err )
                     return Err;
             }
         }
 
-        //
-        // Print all the data
-        //
+        if( auto Err = m_Spill.Write( m_iMemOffet ); Err )
+            return Err;
+
+        if( m_iMemOffet )
         {
-            int L = m_iLine%m_nLinesBeforeFileWrite;
-            if( L == 0 ) L = m_nLinesBeforeFileWrite;
-            for( int l = 0; l<L; ++l )
+            if( auto Err = m_Spill.Write( *m_Memory.data(), m_iMemOffet ); Err )
+                return Err;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Called after the last line of the record. By now the columns have the widths of the
+    //      whole record so each spilled block is loaded back and written with them.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteSpilledBlocks( void ) noexcept
+    {
+        if( auto Err = m_Spill.SeekSet( 0 ); Err )
+            return Err;
+
+        const int iLastLine = m_iLine;
+        for( int iStart = 0; iStart < iLastLine; iStart += m_nLinesBeforeFileWrite )
+        {
+            // The block knows which lines it has (and whether it has the header) from the line index
+            m_iLine = std::min( iStart + m_nLinesBeforeFileWrite, iLastLine );
+
+            for( int i=0; i<m_nColumns; ++i )
             {
-                // Prefix with two spaces to align things
-                if( auto Err = m_File.WriteChar( ' ', 2 ); Err ) 
+                auto& Column = m_Columns[i];
+
+                int nFieldInfos;
+                if( auto Err = m_Spill.Read( nFieldInfos ); Err )
                     return Err;
 
-                for( int i = 0; i<m_nColumns; ++i )
+                Column.m_FieldInfo.resize( nFieldInfos );
+                if( nFieldInfos )
                 {
-                    const auto& Column        = m_Columns[i];
+                    if( auto Err = m_Spill.Read( *Column.m_FieldInfo.data(), static_cast<int>(sizeof(details::field_info)) * nFieldInfos ); Err )
+                        return Err;
+                }
 
-                    if( Column.m_nTypes == -1 )
-                    {
-                        const auto& DynamicFields = Column.m_DynamicFields[l];
+                int nDynamicFields;
+                if( auto Err = m_Spill.Read( nDynamicFields ); Err )
+                    return Err;
 
-                        //
-                        // First write the type
-                        //
-                        if( DynamicFields.m_UserType.m_Value ) 
-                        {
-                            auto p = getUserType( DynamicFields.m_UserType );
-                            assert(p);
-                            if( auto Err = m_File.WriteFmtStr( ";%s", p->m_Name.data() ); Err )
-                                return Err;
+                Column.m_DynamicFields.resize( nDynamicFields );
+                if( nDynamicFields )
+                {
+                    if( auto Err = m_Spill.Read( *Column.m_DynamicFields.data(), static_cast<int>(sizeof(details::field_type)) * nDynamicFields ); Err )
+                        return Err;
+                }
+            }
 
-                            // Fill spaces to reach the next column
-                            if( auto Err = m_File.WriteChar( ' ', Column.m_SubColumn[0].m_FormatWidth - p->m_NameLength -1 + m_nSpacesBetweenFields ); Err )
-                                return Err;
-                        }
-                        else
-                        {
-                            if( auto Err = m_File.WriteFmtStr( ":%s", DynamicFields.m_SystemTypes.data() ); Err )
-                                return Err;
+            if( auto Err = m_Spill.Read( m_iMemOffet ); Err )
+                return Err;
 
-                            // Fill spaces to reach the next column
-                            if( auto Err = m_File.WriteChar( ' ', Column.m_SubColumn[0].m_FormatWidth - DynamicFields.m_nTypes -1 + m_nSpacesBetweenFields ); Err )
-                                return Err;
-                        }
+            if( m_Memory.size() < static_cast<std::size_t>(m_iMemOffet) ) m_Memory.resize( m_iMemOffet );
+            if( m_iMemOffet )
+            {
+                if( auto Err = m_Spill.Read( *m_Memory.data(), m_iMemOffet ); Err )
+                    return Err;
+            }
 
-                        //
-                        // Then write the values
-                        //
-                        for( int n=0; n<DynamicFields.m_nTypes; ++n )
-                        {
-                            const auto& FieldInfo   = Column.m_FieldInfo[ DynamicFields.m_iField + n ];
-                    
-                            if( auto Err = m_File.WriteStr( std::string{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
-                                return Err;
-                                
-                            // Get ready for the next type
-                            if( (DynamicFields.m_nTypes-1) != n)
-                            {
-                                if(auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenFields ); Err )
-                                    return Err;
-                            }
-                        }
+            if( m_pPipeline )
+            {
+                if( auto Err = SubmitTextBlock(); Err )
+                    return Err;
+            }
+            else
+            {
+                if( auto Err = WriteTextBlock(); Err )
+                    return Err;
+            }
+        }
 
-                        // Pad the width to match the columns width
-                        if( auto Err = m_File.WriteChar( ' ',    Column.m_FormatWidth 
-                                                               - DynamicFields.m_FormatWidth
-                                                               - Column.m_SubColumn[0].m_FormatWidth 
-                                                               - m_nSpacesBetweenFields  ); Err )
-                            return Err;
-                    }
-                    else
-                    {
-                        const auto  Center      = Column.m_FormatWidth - Column.m_FormatTotalSubColumns;
+        // Ready for the next record
+        return m_Spill.SeekSet( 0 );
+    }
 
-                        if( (Center>>1) > 0 )
-                        {
-                            if ( auto Err = m_File.WriteChar(' ', Center >> 1); Err) 
-                                return Err;
-                        }
-                            
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Writes the current line of a text record with a single space between values and
+    //      no padding or underline. The parser reads it the same way as the aligned layout.
+    //------------------------------------------------------------------------------
+    xerr stream::WriteCompactLine( void ) noexcept
+    {
+        //
+        // Labels are just a header
+        //
+        if( m_nColumns == -1 )
+        {
+            if( auto Err = WriteRecordHeader( false ); Err )
+                return Err;
+
+            m_iMemOffet = 0;
+            return {};
+        }
+
+        //
+        // The first line writes the record info
+        //
+        if( m_iLine == 1 )
+        {
+            if( auto Err = WriteRecordHeader( false ); Err )
+                return Err;
+        }
+        else if( m_File.m_States.m_isWriteIndex && ((m_iLine - 1) % m_nIndexRowStep) == 0 )
+        {
+            m_Index.m_RowOffsets.push_back( m_File.Tell() );
+        }
 
-                        for( int n=0; n<Column.m_nTypes; ++n )
-                        {
-                            const auto  Index       = l*Column.m_nTypes + n;
-                            const auto& FieldInfo   = Column.m_FieldInfo[ Index ];
-                            const auto& SubColumn   = Column.m_SubColumn[ n ];
+        //
+        // Write the line
+        //
+        for( int i = 0; i<m_nColumns; ++i )
+        {
+            auto& Column = m_Columns[i];
 
-                            if( Column.m_SystemTypes[n] == 'f' || Column.m_SystemTypes[n] == 'F' )
-                            {
-                                // point align Right align
-                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatIntWidth - FieldInfo.m_IntWidth ); Err )
-                                    return Err;
+            if( i )
+            {
+                if( auto Err = m_File.WriteChar( ' ' ); Err )
+                    return Err;
+            }
 
-                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
-                                    return Err;
+            int nTypes = Column.m_nTypes;
+            int iField = 0;
+            if( Column.m_nTypes == -1 )
+            {
+                const auto& DynamicFields = Column.m_DynamicFields[0];
 
-                                // Write spaces to reach the next sub-column
-                                int nSpaces = SubColumn.m_FormatWidth - ( SubColumn.m_FormatIntWidth + FieldInfo.m_Width - FieldInfo.m_IntWidth );
-                                if( auto Err = m_File.WriteChar( ' ', nSpaces ); Err ) 
-                                    return Err;
-                            }
-                            else if( Column.m_SystemTypes[n] == 's' || Column.m_SystemTypes[n] == 'S')
-                            {
-                                // Left align
-                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
-                                    return Err;
+                if( DynamicFields.m_UserType.m_Value ) 
+                {
+                    auto p = getUserType( DynamicFields.m_UserType );
+                    assert(p);
+                    if( auto Err = m_File.WriteFmtStr( ";%s ", p->m_Name.data() ); Err )
+                        return Err;
+                }
+                else
+                {
+                    if( auto Err = m_File.WriteFmtStr( ":%s ", DynamicFields.m_SystemTypes.data() ); Err )
+                        return Err;
+                }
 
-                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatWidth - FieldInfo.m_Width ); Err )
-                                    return Err;
-                            }
-                            else
-                            {
-                                // Right align
-                                if( auto Err = m_File.WriteChar( ' ', SubColumn.m_FormatWidth - FieldInfo.m_Width ); Err )
-                                    return Err;
+                nTypes = DynamicFields.m_nTypes;
+                iField = DynamicFields.m_iField;
+            }
 
-                                if( auto Err = m_File.WriteStr( std::string_view{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) } ); Err )
-                                    return Err;
-                            }
+            for( int n=0; n<nTypes; ++n )
+            {
+                const auto& FieldInfo = Column.m_FieldInfo[ iField + n ];
 
-                            // Write spaces to reach the next sub-column
-                            if( (n+1) != Column.m_nTypes ) 
-                            {
-                                if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenFields ); Err ) 
-                                    return Err;
-                            }
-                        }
+                if( n )
+                {
+                    if( auto Err = m_File.WriteChar( ' ' ); Err )
+                        return Err;
+                }
 
-                        // Add spaces to finish this column
-                        if( Center > 0 )
-                        {
-                            if ( auto Err = m_File.WriteChar(' ', Center - (Center >> 1)); Err ) 
-                                return Err;
-                        }
-                            
-                    }
+                std::string_view Value{ &m_Memory[ FieldInfo.m_iData ], static_cast<std::size_t>(FieldInfo.m_Width) };
 
-                    // Write spaces to reach the next column
-                    if((i+1) != m_nColumns) 
-                    {
-                        if( auto Err = m_File.WriteChar( ' ', m_nSpacesBetweenColumns ); Err ) 
-                            return Err;
-                    }
+                // The line above is already gone so compact lines remember the last value of each type
+                if( m_File.m_States.m_isWriteRepeats && Column.m_nTypes != -1 )
+                {
+                    if( Column.m_RepeatValues.size() < static_cast<std::size_t>(nTypes) ) 
+                        Column.m_RepeatValues.resize( nTypes );
+
+                    if( ((m_iLine - 1) % m_nIndexRowStep) != 0 && Column.m_RepeatValues[n] == Value ) Value = "^";
+                    else                                                                               Column.m_RepeatValues[n] = Value;
                 }
 
-                // End the line
-                if( auto Err = m_File.WriteStr( "\n" ); Err )
+                if( auto Err = m_File.WriteStr( Value ); Err )
                     return Err;
             }
         }
 
+        if( auto Err = m_File.WriteChar( '\n' ); Err )
+            return Err;
+
         //
-        // Reset to get ready for the next block of lines
+        // Get ready for the next line
         //
-        CLEAR:
-        // Clear the columns
         if( m_iLine < m_Record.m_Count )
         {
             for( int i=0; i<m_nColumns; ++i )
@@ -1882,7 +4778,6 @@ namespace xtextfile
                 C.m_FieldInfo.clear();
             }
         }
-        // Clear the memory pointer
         m_iMemOffet = 0;
 
         return {};
@@ -1963,12 +4858,21 @@ namespace xtextfile
             }
             else
             {
+                if( std::strlen( &pFieldName[Column.m_NameLength + 1] ) >= Column.m_SystemTypes.size() )
+                    return Error = xerr::create_f<state, "Fail to read a column, too many types" >();
+
                 Column.m_nTypes = Strcpy_s( Column.m_SystemTypes.data(), Column.m_SystemTypes.size(), &pFieldName[Column.m_NameLength + 1]);
                 if( Column.m_nTypes <= 0 )
                     return Error = xerr::create_f<state, "Fail to read a column, type. not system types specified" >();
 
                 // We remove the null termination
                 Column.m_nTypes--;
+
+                for( int i=0; i<Column.m_nTypes; ++i )
+                {
+                    if( isValidType( Column.m_SystemTypes[i] ) == false )
+                        return Error = xerr::create_f<state, "Fail to read a column, found an unknown type" >();
+                }
             }
 
             Column.m_UserType.m_Value = 0;
@@ -1981,22 +4885,26 @@ namespace xtextfile
 
     xerr stream::ReadFieldUserType( const char* pColumnName ) noexcept
     {
-        if( m_iLine == 1 )
+        // First time we see this field (usually the first line, but a filtered record may skip it)
+        if( m_iColumn == static_cast<int>(m_DataMapping.size()) )
         {
             m_DataMapping.emplace_back() = -1;
             //xassert( m_iColumn == (m_DataMapping.size()-1) );
 
             // Find the column name
-            bool bFound = false;
+            bool      bFound        = false;
+            const int ColumnNameLen = static_cast<int>( std::strlen(pColumnName) );
             for( int i=0; i<m_nColumns; ++i )
             {
                 auto& Column = m_Columns[i];
 
-                if( pColumnName[ Column.m_NameLength ] != 0 )
-                {
-                    if( pColumnName[ Column.m_NameLength ] != ':' || pColumnName[ Column.m_NameLength+1 ] != '?' )
-                        continue;
-                }
+                // A longer name can not match (and we must not read past the end of pColumnName)
+                if( Column.m_NameLength > ColumnNameLen )
+                    continue;
+
+                // Anything after the ':' is for writing (dynamic types or the float precision)
+                if( pColumnName[ Column.m_NameLength ] != 0 && pColumnName[ Column.m_NameLength ] != ':' )
+                    continue;
 
                 // Make sure that we have a match
                 {
@@ -2068,6 +4976,41 @@ namespace xtextfile
         return {};
     }
 
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Tells the reader which columns of the next record the user is going to ask for.
+    //      Columns that are not in the list are skipped rather than decoded by ReadLine, which
+    //      for binary files means we just jump over the bytes and for text files we just skip
+    //      the tokens. The selection only lasts for one record, and an empty list means all columns.
+    //------------------------------------------------------------------------------
+    void stream::SelectColumns( std::span<const std::string_view> ColumnNames ) noexcept
+    {
+        m_SelectedColumns.clear();
+        for( auto Name : ColumnNames )
+        {
+            // Dynamic columns can be named with or without the ":?"
+            if( Name.ends_with(":?") ) Name.remove_suffix(2);
+            m_SelectedColumns.emplace_back(Name);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    void stream::ApplyColumnSelection( void ) noexcept
+    {
+        for( int i=0; i<m_nColumns; ++i )
+        {
+            auto& Column = m_Columns[i];
+
+            // When validating binary files we only need to walk the data
+            Column.m_bSkip = m_bValidateOnly && m_File.m_States.m_isBinary;
+            if( Column.m_bSkip || m_SelectedColumns.empty() ) continue;
+
+            const std::string_view Name{ Column.m_Name.data(), static_cast<std::size_t>(Column.m_NameLength) };
+            Column.m_bSkip = std::find( m_SelectedColumns.begin(), m_SelectedColumns.end(), Name ) == m_SelectedColumns.end();
+        }
+    }
+
     //------------------------------------------------------------------------------
 
     xerr stream::ReadColumn( const crc32 iUserRef, const char* pColumnName, std::span<details::arglist::types> Args ) noexcept
@@ -2125,6 +5068,14 @@ namespace xtextfile
         //
         auto& Column = m_Columns[m_DataMapping[m_iColumn]];
 
+        //
+        // The user told us not to decode this column
+        //
+        if( Column.m_bSkip )
+        {
+            return Error = xerr::create< state::FIELD_NOT_FOUND, "Reading a column that was not part of SelectColumns" >();
+        }
+
         //
         // if the type is '?' then check the types every call
         //
@@ -2156,6 +5107,15 @@ namespace xtextfile
         for( int i=0; i<Args.size(); i++ )
         {
             const auto& E    = Args[i];
+
+            // Decode the field if it was left as a token
+            if( auto& Info = Column.m_FieldInfo[i]; Info.m_bDeferred )
+            {
+                const int SystemType = Column.m_nTypes == -1 ? Column.m_DynamicFields[0].m_SystemTypes[i] : Column.m_SystemTypes[i];
+                if( Error = DecodeNumber( Info, &m_Memory[Info.m_iData], SystemType ); Error )
+                    return Error;
+            }
+
             const auto iData = Column.m_FieldInfo[i].m_iData;
 
             std::visit( [&]( auto p )
@@ -2180,32 +5140,319 @@ namespace xtextfile
                 }
                 else if constexpr (std::is_same_v<t, std::string*> )
                 {
-                    *p = &m_Memory[iData];
+                    // Binary strings know their size so they can have nulls inside
+                    if (m_File.m_States.m_isBinary) p->assign( &m_Memory[iData], static_cast<std::size_t>(Column.m_FieldInfo[i].m_Width - 1) );
+                    else                            *p = &m_Memory[iData];
+                }
+                else if constexpr (std::is_same_v<t, std::wstring*>)
+                {
+                    if (m_File.m_States.m_isBinary) p->assign( reinterpret_cast<wchar_t*>(&m_Memory[iData]), static_cast<std::size_t>(Column.m_FieldInfo[i].m_Width - 2) / sizeof(wchar_t) );
+                    else                            *p = details::ascii_escape_to_wstring( &m_Memory[iData] );
+                }
+                else
+                {
+                    // We can not handle whatever type you are trying to use...
+                    assert( false );
+                }
+            }, E );
+        }
+
+        //
+        // The user_types reference
+        //
+     //   iUserRef = static_cast<int>(Column.m_UserType.m_Value);
+
+        //
+        // Ready to read the next column
+        //
+        m_iColumn++;
+
+        return Error;
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Checks the syntax of a numeric token from a text file against its type without
+    //      decoding it anywhere. Used when validating files.
+    //------------------------------------------------------------------------------
+    xerr stream::ValidateNumber( const char* pToken, int Length, int SystemType ) const noexcept
+    {
+        const char* pEnd = pToken + Length;
+
+        switch( SystemType )
+        {
+            case 's': case 'S': return xerr::create< state::MISMATCH_TYPES, "Found a numeric value while expecting a string" >();
+        }
+
+        //
+        // Hex values hold the bits so they can not be larger than the type
+        //
+        if( pToken[0] == '#' )
+        {
+            int MaxDigits = 16;
+            switch( SystemType )
+            {
+                case 'c': case 'h':             MaxDigits = 2; break;
+                case 'C': case 'H':             MaxDigits = 4; break;
+                case 'f': case 'd': case 'g':   MaxDigits = 8; break;
+            }
+
+            if( (Length - 1) > MaxDigits )
+                return xerr::create< state::MISMATCH_TYPES, "Found a hex value that is too large for its type" >();
+
+            return {};
+        }
+
+        if( SystemType == 'f' || SystemType == 'F' )
+        {
+            double      x;
+            const auto  R = std::from_chars( pToken, pEnd, x );
+            if( R.ec != std::errc{} || R.ptr != pEnd )
+                return xerr::create_f< state, "Found a malformed floating point value" >();
+
+            return {};
+        }
+
+        if( std::strpbrk( pToken, ".eE" ) )
+            return xerr::create< state::MISMATCH_TYPES, "I found a floating point number while trying to load an integer value" >();
+
+        if( pToken[0] == '-' )
+        {
+            std::int64_t x;
+            const auto   R = std::from_chars( pToken, pEnd, x );
+            if( R.ec != std::errc{} || R.ptr != pEnd )
+                return xerr::create_f< state, "Found a malformed integer value" >();
+        }
+        else
+        {
+            std::uint64_t x;
+            const auto    R = std::from_chars( pToken, pEnd, x );
+            if( R.ec != std::errc{} || R.ptr != pEnd )
+                return xerr::create_f< state, "Found a malformed integer value" >();
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Converts a numeric token from a text file into its binary form inside m_Memory.
+    //      Hex tokens start with '#' and hold the bits of the value.
+    //------------------------------------------------------------------------------
+    xerr stream::DecodeNumber( details::field_info& Info, const char* pToken, int SystemType ) noexcept
+    {
+        std::uint64_t H;
+
+        if( pToken[0] == '#' )
+        {
+            H = strtoull( &pToken[1], nullptr, 16);
+        }
+        else
+        {
+            const bool isInt = std::strpbrk( pToken, ".eE" ) == nullptr;
+
+            // Floats are parsed straight into their own type so the shortest form written reads back exactly
+            if( SystemType == 'F' ) 
+            {
+                double x = 0;
+                std::from_chars( pToken, pToken + std::strlen(pToken), x );
+                reinterpret_cast<double&>(H) = x;
+            }
+            else if( SystemType == 'f' )
+            {
+                float x = 0;
+                std::from_chars( pToken, pToken + std::strlen(pToken), x );
+                H = 0;
+                reinterpret_cast<float&>(H)  = x;
+            }
+            else if( isInt == false )
+            {
+                return xerr::create< state::MISMATCH_TYPES, "I found a floating point number while trying to load an integer value" >();
+            }
+            else if( pToken[0] == '-' )
+            {
+                if(    SystemType == 'g' 
+                    || SystemType == 'G' 
+                    || SystemType == 'h' 
+                    || SystemType == 'H' )
+                {
+                    printf("Reading a sign integer into a field which is unsigned-int form this record [%s](%d)\n", m_Record.m_Name.data(), m_iLine);
+                }
+
+                H = static_cast<std::uint64_t>(strtoll( pToken, nullptr, 10));
+            }
+            else
+            {
+                H = static_cast<std::uint64_t>(strtoull( pToken, nullptr, 10));
+                if(    (SystemType == 'c' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int8_t>::max() ))
+                    || (SystemType == 'C' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int16_t>::max()))
+                    || (SystemType == 'd' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()))
+                    || (SystemType == 'D' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+                    )
+                {
+                    printf("Reading a sign integer but the value in the file exceeds the allow positive integer portion in record [%s](%d)\n", m_Record.m_Name.data(), m_iLine);
+                }
+            }
+        }
+
+        // Deferred tokens get decoded after the line was read so make sure we have the memory
+        if( (m_iMemOffet + 16) > static_cast<int>(m_Memory.size()) ) 
+            m_Memory.resize( m_Memory.size() + 1024 );
+
+        Info.m_bDeferred = false;
+        switch( SystemType )
+        {
+            case 'c': 
+            case 'h':
+                        Info.m_iData = align_to( m_iMemOffet, 1); m_iMemOffet = Info.m_iData + 1; reinterpret_cast<std::uint8_t &>(m_Memory[Info.m_iData]) = static_cast<std::uint8_t>(H);
+                        break;
+            case 'C':
+            case 'H':
+                        Info.m_iData = align_to( m_iMemOffet, 2); m_iMemOffet = Info.m_iData + 2; reinterpret_cast<std::uint16_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint16_t>(H);
+                        break;
+            case 'f':
+            case 'd':
+            case 'g':
+                        Info.m_iData = align_to( m_iMemOffet, 4); m_iMemOffet = Info.m_iData + 4; reinterpret_cast<std::uint32_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint32_t>(H);
+                        break;
+            case 'F':
+            case 'G':
+            case 'D':
+                        Info.m_iData = align_to( m_iMemOffet, 8); m_iMemOffet = Info.m_iData + 8; reinterpret_cast<std::uint64_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint64_t>(H);
+                        break;
+        }
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    xerr stream::ReadTypes( void ) noexcept
+    {
+        int                     c;
+        int                     Size=0;
+        std::array<char,256>    Buffer;
+
+        if( m_File.m_States.m_isBinary )
+        {
+            // Read the number of columns
+            {
+                std::uint8_t nColumns;
+                if( auto Err = m_File.Read(nColumns); Err ) 
+                    return Err;
+
+                m_nColumns = nColumns;
+                m_Columns.clear();
+                m_Columns.resize( m_nColumns );
+            }
+
+            //
+            // Read all the types
+            //
+            for( int l=0; l<m_nColumns; l++)
+            {
+                auto& Column = m_Columns[l];
+
+                // Name
+                Column.m_NameLength = 0;
+                do 
+                {
+                    if( auto Err = m_File.getC(c); Err ) 
+                        return Err;
+
+                    if( Column.m_NameLength >= static_cast<int>(Column.m_Name.size()) )
+                        return xerr::create_f< state, "Found a column name that is way too long" >();
+
+                    Column.m_Name[Column.m_NameLength++] = c;
+                } while( c != ':'
+                      && c != ';'
+                      && c != '?' );
+
+                Column.m_NameLength--;
+                Column.m_Name[Column.m_NameLength] = 0;
+
+                // Read type information
+                if( c == ':' )
+                {
+                    Column.m_nTypes = 0;
+                    do 
+                    {
+                        if( auto Err = m_File.getC(c); Err ) 
+                            return Err;
+
+                        if( c && isValidType(c) == false )
+                            return xerr::create_f< state, "Found an unknown type in a column" >();
+
+                        if( Column.m_nTypes >= static_cast<int>(Column.m_SystemTypes.size()) )
+                            return xerr::create_f< state, "Found a column with too many types" >();
+
+                        Column.m_SystemTypes[Column.m_nTypes++] = c;
+                    } while(c);
+                    Column.m_nTypes--;
+                    Column.m_UserType.m_Value = 0;
                 }
-                else if constexpr (std::is_same_v<t, std::wstring*>)
-                {
-                    if (m_File.m_States.m_isBinary) *p = reinterpret_cast<wchar_t*>(&m_Memory[iData]);
-                    else                            *p = details::ascii_escape_to_wstring( &m_Memory[iData] );
+                else if( c == ';' )
+                { 
+                    std::uint8_t Index;
+                    if( auto Err = m_File.Read(Index); Err )    
+                        return Err;
+
+                    if( Index >= m_UserTypes.size() )
+                        return xerr::create_f< state, "Found a column with an unknown user type" >();
+
+                    auto& UserType = m_UserTypes[Index];
+                    Column.m_UserType       = UserType.m_CRC;
+                    Column.m_nTypes         = UserType.m_nSystemTypes;
+                    Column.m_FormatWidth    = Index;
                 }
-                else
+                else if( c == '?' )
                 {
-                    // We can not handle whatever type you are trying to use...
-                    assert( false );
+                    Column.m_nTypes = -1;
+                    Column.m_UserType.m_Value = 0;
                 }
-            }, E );
+            }
         }
+        else
+        {
+            // Read out all the white space
+            if( auto Err = m_File.ReadWhiteSpace(c); Err )
+                return Err;
 
-        //
-        // The user_types reference
-        //
-     //   iUserRef = static_cast<int>(Column.m_UserType.m_Value);
+            //
+            // we should have the right character by now
+            //
+            if( c != '{' ) return xerr::create_f< state, "Unable to find the types" >();
 
-        //
-        // Ready to read the next column
-        //
-        m_iColumn++;
+            // Get the next token
+            if( auto Err = m_File.ReadWhiteSpace(c); Err )
+                return Err;
 
-        return Error;
+            do
+            {
+                // Read a word
+                Size=0;
+                while( ValidateColumnChar(c) || c == ';' || c == ':' )
+                {
+                    Buffer[Size++] = c;                    
+                    if( auto Err = m_File.getC(c); Err ) 
+                        return Err;
+                }
+    
+                // Terminate the string
+                Buffer[Size++] = 0;
+
+                // Okay build the type information
+                if( auto Err = BuildTypeInformation( Buffer.data() ); Err ) 
+                    return Err;
+
+                // Read any white space
+                if( auto Err = m_File.ReadWhiteSpace(c); Err )
+                    return Err;
+
+            } while( c != '}' );
+        }
+
+        return {};
     }
 
     //------------------------------------------------------------------------------
@@ -2219,6 +5466,9 @@ namespace xtextfile
         // Make sure that the user_types doesn't read more lines than the record has
         assert( m_iLine <= m_Record.m_Count );
 
+        // Reset the memory count
+        m_iMemOffet = 0;
+
         //
         // If it is the first line we must read the type information before hand
         //
@@ -2227,120 +5477,146 @@ namespace xtextfile
             // Reset the user_types field offsets
             m_DataMapping.clear();
 
-            // Solve types
-            if( m_File.m_States.m_isBinary )
+            // Solve types (unless they were already read, ex: when seeking to a row)
+            if( m_nColumns == 0 )
+            {
+                if( auto Err = ReadTypes(); Err )
+                    return Err;
+            }
+
+            // Mark the columns that the user does not want to decode
+            ApplyColumnSelection();
+        }
+
+        //
+        // Read the actual data
+        //
+        if( m_File.m_States.m_isBinary )
+        {
+            if( m_iLine == 0 ) 
+                PlanFixedRows();
+
+            if( m_FixedRows.m_RowBytes )
+            {
+                if( auto Err = ReadFixedRow(); Err )
+                    return Err;
+
+                m_iMemOffet = static_cast<int>(m_Memory.size());
+                m_iLine++;
+                m_iColumn = 0;
+                return {};
+            }
+
+            // Records with more than one block are decoded by the workers
+            if( m_File.m_States.m_isBlocks )
             {
-                // Read the number of columns
+                if( m_bValidateOnly == false && m_Record.m_Count > m_nLinesBeforeFileWrite )
+                    return ReadDecodedRow();
+
+                if( m_BlockCursor.m_nLeft == 0 )
                 {
-                    std::uint8_t nColumns;
-                    if( auto Err = m_File.Read(nColumns); Err ) 
+                    if( auto Err = ReadBlockHeader(); Err )
                         return Err;
 
-                    m_nColumns = nColumns;
-                    m_Columns.clear();
-                    m_Columns.resize( m_nColumns );
+                    if( auto Err = UnpackBlock(); Err )
+                        return Err;
                 }
+                m_BlockCursor.m_nLeft--;
+            }
 
-                //
-                // Read all the types
-                //
-                for( int l=0; l<m_nColumns; l++)
+            //
+            // Skipping fixed size data is just size arithmetic so we accumulate the bytes
+            // and only move the file cursor when we need to
+            //
+            int nPendingSkip = 0;
+            auto SkipData = [&]( int SystemType ) ->xerr
+            {
+                switch( SystemType )
                 {
-                    auto& Column = m_Columns[l];
-
-                    // Name
-                    Column.m_NameLength = 0;
-                    do 
+                    case 'c': case 'h':             nPendingSkip += 1; break;
+                    case 'C': case 'H':             nPendingSkip += 2; break;
+                    case 'f': case 'd': case 'g':   nPendingSkip += 4; break;
+                    case 'F': case 'G': case 'D':   nPendingSkip += 8; break;
+                    case 's':
                     {
-                        if( auto Err = m_File.getC(c); Err ) 
+                        if( auto Err = m_File.Skip(nPendingSkip); Err )
                             return Err;
+                        nPendingSkip = 0;
 
-                        Column.m_Name[Column.m_NameLength++] = c;
-                    } while( c != ':'
-                          && c != ';'
-                          && c != '?' );
-
-                    Column.m_NameLength--;
-                    Column.m_Name[Column.m_NameLength] = 0;
+                        if( m_File.m_States.m_isStringLength )
+                        {
+                            std::uint32_t Length;
+                            if( auto Err = m_File.ReadVarint(Length); Err )
+                                return Err;
+                            nPendingSkip = static_cast<int>(Length);
+                            break;
+                        }
 
-                    // Read type information
-                    if( c == ':' )
-                    {
-                        Column.m_nTypes = 0;
-                        do 
+                        do
                         {
                             if( auto Err = m_File.getC(c); Err ) 
                                 return Err;
-
-                            Column.m_SystemTypes[Column.m_nTypes++] = c;
                         } while(c);
-                        Column.m_nTypes--;
-                        Column.m_UserType.m_Value = 0;
+                        break;
                     }
-                    else if( c == ';' )
-                    { 
-                        std::uint8_t Index;
-                        if( auto Err = m_File.Read(Index); Err )    
+                    case 'S':
+                    {
+                        if( auto Err = m_File.Skip(nPendingSkip); Err )
                             return Err;
+                        nPendingSkip = 0;
 
-                        auto& UserType = m_UserTypes[Index];
-                        Column.m_UserType       = UserType.m_CRC;
-                        Column.m_nTypes         = UserType.m_nSystemTypes;
-                        Column.m_FormatWidth    = Index;
-                    }
-                    else if( c == '?' )
-                    {
-                        Column.m_nTypes = -1;
-                        Column.m_UserType.m_Value = 0;
+                        if( m_File.m_States.m_isStringLength )
+                        {
+                            std::uint32_t Length;
+                            if( auto Err = m_File.ReadVarint(Length); Err )
+                                return Err;
+                            nPendingSkip = static_cast<int>(Length) * 2;
+                            break;
+                        }
+
+                        short x;
+                        do
+                        {
+                            if( auto Err = m_File.Read( x, 2, 1); Err ) 
+                                return Err;
+                        } while(x);
+                        break;
                     }
                 }
-            }
-            else
+                return {};
+            };
+
+            // Strings with their length in front are read with a single copy (CharSize is 1 for 's' and 2 for 'S')
+            auto ReadString = [&]( details::field_info& Info, int CharSize ) ->xerr
             {
-                // Read out all the white space
-                if( auto Err = m_File.ReadWhiteSpace(c); Err )
+                std::uint32_t Length;
+                if( auto Err = m_File.ReadVarint(Length); Err )
                     return Err;
 
-                //
-                // we should have the right character by now
-                //
-                if( c != '{' ) return xerr::create_f< state, "Unable to find the types" >();
+                if( Length > (1u << 28) )
+                    return xerr::create_f< state, "Found a string that is too long" >();
 
-                // Get the next token
-                if( auto Err = m_File.ReadWhiteSpace(c); Err )
-                    return Err;
+                const int Bytes = static_cast<int>(Length) * CharSize;
+                Info.m_iData = align_to( m_iMemOffet, CharSize );
+                if( static_cast<std::size_t>(Info.m_iData + Bytes + CharSize) > m_Memory.size() )
+                    m_Memory.resize( Info.m_iData + Bytes + CharSize + 1024 );
 
-                do
+                if( Bytes )
                 {
-                    // Read a word
-                    Size=0;
-                    while( ValidateColumnChar(c) || c == ';' || c == ':' )
-                    {
-                        Buffer[Size++] = c;                    
-                        if( auto Err = m_File.getC(c); Err ) 
-                            return Err;
-                    }
-            
-                    // Terminate the string
-                    Buffer[Size++] = 0;
-
-                    // Okay build the type information
-                    if( auto Err = BuildTypeInformation( Buffer.data() ); Err ) 
+                    if( auto Err = m_File.Read( m_Memory[Info.m_iData], Bytes, 1 ); Err )
                         return Err;
 
-                    // Read any white space
-                    if( auto Err = m_File.ReadWhiteSpace(c); Err )
-                        return Err;
+                    if( CharSize == 2 && m_File.m_States.m_isEndianSwap )
+                        endian::SwapBlock( &m_Memory[Info.m_iData], Length, 2 );
+                }
 
-                } while( c != '}' );
-            }
-        }
+                // The strings in memory are still terminated
+                std::memset( &m_Memory[Info.m_iData + Bytes], 0, CharSize );
+                m_iMemOffet  = Info.m_iData + Bytes + CharSize;
+                Info.m_Width = m_iMemOffet - Info.m_iData;
+                return {};
+            };
 
-        //
-        // Read the actual data
-        //
-        if( m_File.m_States.m_isBinary )
-        {
             auto ReadData = [&]( details::field_info& Info, int SystemType ) ->xerr
             {
                 switch( SystemType )
@@ -2363,6 +5639,9 @@ namespace xtextfile
                         if( auto Err = m_File.Read(H); Err ) 
                             return Err;
 
+                        if( m_File.m_States.m_isEndianSwap ) 
+                            H = endian::Convert(H);
+
                         Info.m_iData = align_to( m_iMemOffet, 2); m_iMemOffet = Info.m_iData + 2; reinterpret_cast<std::uint16_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint16_t>(H);
                         Info.m_Width = 2;
                         break;
@@ -2375,6 +5654,9 @@ namespace xtextfile
                         if( auto Err = m_File.Read(H); Err ) 
                             return Err;
 
+                        if( m_File.m_States.m_isEndianSwap ) 
+                            H = endian::Convert(H);
+
                         Info.m_iData = align_to( m_iMemOffet, 4); m_iMemOffet = Info.m_iData + 4; reinterpret_cast<std::uint32_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint32_t>(H);
                         Info.m_Width = 4;
                         break;
@@ -2387,12 +5669,18 @@ namespace xtextfile
                         if( auto Err = m_File.Read(H); Err ) 
                             return Err;
 
+                        if( m_File.m_States.m_isEndianSwap ) 
+                            H = endian::Convert(H);
+
                         Info.m_iData = align_to( m_iMemOffet, 8); m_iMemOffet = Info.m_iData + 8; reinterpret_cast<std::uint64_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint64_t>(H);
                         Info.m_Width = 8;
                         break;
                     }
                     case 's':
                     {
+                        if( m_File.m_States.m_isStringLength ) 
+                            return ReadString( Info, 1 );
+
                         int c;
                         Info.m_iData = m_iMemOffet;
                         do
@@ -2400,6 +5688,9 @@ namespace xtextfile
                             if( auto Err = m_File.getC(c); Err ) 
                                 return Err;
 
+                            if( m_iMemOffet >= static_cast<int>(m_Memory.size()) ) 
+                                m_Memory.resize( m_Memory.size() + 1024 );
+
                             m_Memory[m_iMemOffet++] = c;
                         } while(c); 
                         Info.m_Width = m_iMemOffet - Info.m_iData;
@@ -2407,6 +5698,9 @@ namespace xtextfile
                     }
                     case 'S':
                     {
+                        if( m_File.m_States.m_isStringLength ) 
+                            return ReadString( Info, 2 );
+
                         short c;
                         Info.m_iData = align_to(m_iMemOffet, 2);
                         m_iMemOffet = Info.m_iData;
@@ -2415,6 +5709,12 @@ namespace xtextfile
                             if (auto Err = m_File.Read( c, 2, 1); Err ) 
                                 return Err;
 
+                            if( m_File.m_States.m_isEndianSwap ) 
+                                c = static_cast<short>( endian::Convert( static_cast<std::uint16_t>(c) ) );
+
+                            if( (m_iMemOffet + 2) > static_cast<int>(m_Memory.size()) ) 
+                                m_Memory.resize( m_Memory.size() + 1024 );
+
                             m_Memory[m_iMemOffet++] = (c >> 0) & 0xff;
                             m_Memory[m_iMemOffet++] = (c >> 8) & 0xff;
 
@@ -2438,6 +5738,11 @@ namespace xtextfile
                     auto& D = Column.m_DynamicFields.emplace_back();
                     D.m_iField = 0;
 
+                    // The type information follows so we need the cursor to be in the right place
+                    if( auto Err = m_File.Skip(nPendingSkip); Err )
+                        return Err;
+                    nPendingSkip = 0;
+
                     // Get the first key code
                     if( auto Err = m_File.getC(c); Err ) 
                         return Err;
@@ -2451,6 +5756,12 @@ namespace xtextfile
                             if( auto Err = m_File.getC(c); Err ) 
                                 return Err;
 
+                            if( c && isValidType(c) == false )
+                                return xerr::create_f< state, "Found an unknown type in a column" >();
+
+                            if( D.m_nTypes >= static_cast<int>(D.m_SystemTypes.size()) )
+                                return xerr::create_f< state, "Found a column with too many types" >();
+
                             D.m_SystemTypes[D.m_nTypes++] = c;
                         } while(c);
                         D.m_nTypes--;
@@ -2462,6 +5773,9 @@ namespace xtextfile
                         if( auto Err = m_File.Read(Index); Err ) 
                             return Err;
 
+                        if( Index >= m_UserTypes.size() )
+                            return xerr::create_f< state, "Found a column with an unknown user type" >();
+
                         auto& UserType = m_UserTypes[Index];
                         D.m_UserType = UserType.m_CRC;
                         D.m_nTypes   = UserType.m_nSystemTypes;
@@ -2469,7 +5783,7 @@ namespace xtextfile
                     }
                     else
                     {
-                        assert(false);
+                        return xerr::create_f< state, "Expecting a type definition" >();
                     }
 
                     //
@@ -2477,12 +5791,30 @@ namespace xtextfile
                     //
                     for( int i=0; i<D.m_nTypes; i++ )
                     {
-                        if( auto Err = ReadData( Column.m_FieldInfo.emplace_back(), D.m_SystemTypes[i] ); Err ) 
+                        if( Column.m_bSkip )
+                        {
+                            if( auto Err = SkipData( D.m_SystemTypes[i] ); Err )
+                                return Err;
+                        }
+                        else if( auto Err = ReadData( Column.m_FieldInfo.emplace_back(), D.m_SystemTypes[i] ); Err ) 
+                            return Err;
+                    }
+                }
+                else if( Column.m_bSkip )
+                {
+                    const char* pSystemTypes = Column.m_UserType.m_Value ? m_UserTypes[Column.m_FormatWidth].m_SystemTypes.data() : Column.m_SystemTypes.data();
+                    for( int i=0; i<Column.m_nTypes; i++ )
+                    {
+                        if( auto Err = SkipData( pSystemTypes[i] ); Err )
                             return Err;
                     }
                 }
                 else
                 {
+                    if( auto Err = m_File.Skip(nPendingSkip); Err )
+                        return Err;
+                    nPendingSkip = 0;
+
                     //
                     // Read all the data
                     //
@@ -2505,6 +5837,10 @@ namespace xtextfile
                     }
                 }
             }
+
+            // Skip what ever is left of the line
+            if( auto Err = m_File.Skip(nPendingSkip); Err )
+                return Err;
         }
         else
         {
@@ -2519,18 +5855,82 @@ namespace xtextfile
                         return Err;
                 }
 
+                //
+                // ^ means the same value as the line above so we copy what we got for it
+                //
+                if( c == '^' )
+                {
+                    if( auto Err = m_File.getC(c); Err ) 
+                        return Err;
+
+                    if( c != ' ' && c != '\n' ) 
+                        return xerr::create_f< state, "Expecting a space separator but I got a different character" >();
+
+                    if( m_bValidateOnly )
+                    {
+                        if( m_iLine == 0 ) 
+                            return xerr::create_f< state, "Found a repeated value (^) in the first line of a record" >();
+                        return {};
+                    }
+
+                    const auto& Column = m_Columns[m_iColumn];
+                    const auto  iField = static_cast<std::size_t>( &Info - Column.m_FieldInfo.data() );
+                    if( iField >= Column.m_PrevFieldInfo.size() )
+                        return xerr::create_f< state, "Found a repeated value (^) without a value above it" >();
+
+                    const auto& Above = Column.m_PrevFieldInfo[iField];
+                    int         Bytes = 8;
+                    int         Align = 8;
+                    if( Above.m_bDeferred )
+                    {
+                        Bytes = Above.m_Width;
+                        Align = 1;
+                    }
+                    else switch( SystemType )
+                    {
+                        case 's': case 'S':             Bytes = static_cast<int>( std::strlen( &m_PrevMemory[Above.m_iData] ) ) + 1; Align = 1; break;
+                        case 'c': case 'h':             Bytes = Align = 1; break;
+                        case 'C': case 'H':             Bytes = Align = 2; break;
+                        case 'f': case 'd': case 'g':   Bytes = Align = 4; break;
+                    }
+
+                    Info         = Above;
+                    Info.m_iData = align_to( m_iMemOffet, Align );
+                    if( (Info.m_iData + Bytes) > static_cast<int>(m_Memory.size()) ) 
+                        m_Memory.resize( Info.m_iData + Bytes + 1024 );
+
+                    std::memcpy( &m_Memory[Info.m_iData], &m_PrevMemory[Above.m_iData], Bytes );
+                    m_iMemOffet = Info.m_iData + Bytes;
+                    return {};
+                }
+
                 Size = 0;
                 if ( c == '"' )
                 {
                     if( SystemType != 's' && SystemType != 'S')
                         return xerr::create_f< state, "Unexpected string value expecting something else">();
 
+                    // When validating we only care that the string is terminated
+                    if( m_bValidateOnly )
+                    {
+                        do 
+                        {
+                            if( auto Err = m_File.getC(c); Err ) 
+                                return xerr::create_f< state, "Found a string without its closing quote" >();
+                        } while( c != '"' );
+
+                        return {};
+                    }
+
                     Info.m_iData = m_iMemOffet;
                     do 
                     {
                         if( auto Err = m_File.getC(c); Err ) 
                             return Err;
 
+                        if( m_iMemOffet >= static_cast<int>(m_Memory.size()) ) 
+                            m_Memory.resize( m_Memory.size() + 1024 );
+
                         m_Memory[m_iMemOffet++] = c;
                     } while( c != '"' );
 
@@ -2538,137 +5938,128 @@ namespace xtextfile
                 }
                 else
                 {
-                    std::uint64_t H;
+                    // Adds the current character to the token and gets the next one
+                    auto Append = [&]() noexcept ->xerr
+                    {
+                        if( Size >= static_cast<int>(Buffer.size() - 1) )
+                            return xerr::create_f< state, "Found a numeric value that is way too long" >();
+
+                        Buffer[Size++] = c;
+                        return m_File.getC(c);
+                    };
 
                     if( c == '#' )
                     {
-                        if( auto Err = m_File.getC(c); Err ) 
+                        if( auto Err = Append(); Err ) 
                             return Err;
 
                         while(ishex(c) )
                         {
-                            Buffer[Size++] = c;                    
-                            if( auto Err = m_File.getC(c); Err ) 
+                            if( auto Err = Append(); Err ) 
                                 return Err;
                         }
 
-                        if( Size == 0 )
+                        if( Size == 1 )
                         {
                             return xerr::create_f< state, "Fail to read a numeric value" >();
                         }
-                            
-
-                        Buffer[Size++] = 0;
-
-                        H = strtoull( Buffer.data(), nullptr, 16);
                     }
                     else
                     {
-                        bool isInt = true;
-
                         if( c == '-' )
                         {
-                            Buffer[Size++] = c;                    
-                            if( auto Err = m_File.getC(c); Err ) 
+                            if( auto Err = Append(); Err ) 
                                 return Err;
                         }
 
                         while( std::isdigit(c) ) 
                         {
-                            Buffer[Size++] = c;                    
-                            if( auto Err = m_File.getC(c); Err ) 
+                            if( auto Err = Append(); Err ) 
                                 return Err;
 
-                            if( c == '.' )
+                            if( c == '.' || c == 'e' || c == 'E' )
                             {
-                                // Continue reading as a float
-                                isInt = false;
+                                // Continue reading as a float (the exponent may come without a '.' ex: 1e+20)
                                 do 
                                 {
-                                    Buffer[Size++] = c;                    
-                                    if( auto Err = m_File.getC(c); Err ) 
+                                    if( auto Err = Append(); Err ) 
                                         return Err;
                                     
-                                } while( std::isdigit(c) || c == 'e' || c == 'E' || c == '-' );
+                                } while( std::isdigit(c) || c == 'e' || c == 'E' || c == '-' || c == '+' );
                                 break;
                             }
                         }
 
                         if( Size == 0 )
                             return xerr::create_f< state, "Fail to read a numeric value" >();
+                    }
 
-                        Buffer[Size++] = 0;
+                    Buffer[Size++] = 0;
 
+                    if( c != ' ' && c != '\n' ) 
+                        return xerr::create_f< state, "Expecting a space separator but I got a different character" >();
 
-                        if( SystemType == 'F' ) 
-                        {
-                            double x = atof(Buffer.data());
-                            reinterpret_cast<double&>(H) = x;
-                        }
-                        else if( SystemType == 'f' )
-                        {
-                            float x = static_cast<float>(atof(Buffer.data()));
-                            reinterpret_cast<float&>(H)  = x;
-                        }
-                        else if( isInt == false )
-                        {
-                            return xerr::create< state::MISMATCH_TYPES, "I found a floating point number while trying to load an integer value" >();
-                        }
-                        else if( Buffer[0] == '-' )
-                        {
-                            if(    SystemType == 'g' 
-                                || SystemType == 'G' 
-                                || SystemType == 'h' 
-                                || SystemType == 'H' )
-                            {
-                                printf("Reading a sign integer into a field which is unsigned-int form this record [%s](%d)\n", m_Record.m_Name.data(), m_iLine);
-                            }
+                    if( m_bValidateOnly )
+                        return ValidateNumber( Buffer.data(), Size - 1, SystemType );
 
-                            H = static_cast<std::uint64_t>(strtoll( Buffer.data(), nullptr, 10));
-                        }
-                        else
-                        {
-                            H = static_cast<std::uint64_t>(strtoull( Buffer.data(), nullptr, 10));
-                            if(    (SystemType == 'c' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int8_t>::max() ))
-                                || (SystemType == 'C' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int16_t>::max()))
-                                || (SystemType == 'd' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()))
-                                || (SystemType == 'D' && H >= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
-                                )
-                            {
-                                printf("Reading a sign integer but the value in the file exceeds the allow positive integer portion in record [%s](%d)\n", m_Record.m_Name.data(), m_iLine);
-                            }
-                        }
+                    //
+                    // When deferring we just keep the token and decode it only if the user asks for it
+                    //
+                    if( m_bDeferDecode )
+                    {
+                        if( (m_iMemOffet + Size) > static_cast<int>(m_Memory.size()) ) 
+                            m_Memory.resize( m_Memory.size() + 1024 );
+
+                        Info.m_iData     = m_iMemOffet;
+                        Info.m_Width     = Size;
+                        Info.m_bDeferred = true;
+                        std::memcpy( &m_Memory[m_iMemOffet], Buffer.data(), Size );
+                        m_iMemOffet += Size;
+                        return {};
                     }
 
-                    if( c != ' ' && c != '\n' ) 
-                        return xerr::create_f< state, "Expecting a space separator but I got a different character" >();
+                    return DecodeNumber( Info, Buffer.data(), SystemType );
+                }
 
-                    switch( SystemType )
-                    {
-                        case 'c': 
-                        case 'h':
-                                    Info.m_iData = align_to( m_iMemOffet, 1); m_iMemOffet = Info.m_iData + 1; reinterpret_cast<std::uint8_t &>(m_Memory[Info.m_iData]) = static_cast<std::uint8_t>(H);
-                                    break;
-                        case 'C':
-                        case 'H':
-                                    Info.m_iData = align_to( m_iMemOffet, 2); m_iMemOffet = Info.m_iData + 2; reinterpret_cast<std::uint16_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint16_t>(H);
-                                    break;
-                        case 'f':
-                        case 'd':
-                        case 'g':
-                                    Info.m_iData = align_to( m_iMemOffet, 4); m_iMemOffet = Info.m_iData + 4; reinterpret_cast<std::uint32_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint32_t>(H);
-                                    break;
-                        case 'F':
-                        case 'G':
-                        case 'D':
-                                    Info.m_iData = align_to( m_iMemOffet, 8); m_iMemOffet = Info.m_iData + 8; reinterpret_cast<std::uint64_t&>(m_Memory[Info.m_iData]) = static_cast<std::uint64_t>(H);
-                                    break;
-                    }
+                return {};
+            };
+
+            //
+            // Skipping a component is just finding where the token ends
+            //
+            auto SkipComponent = [&]( void ) noexcept ->xerr
+            {
+                if( c == ' ' )
+                {
+                    if (auto Err = m_File.ReadWhiteSpace(c); Err)
+                        return Err;
+                }
+
+                if( c == '"' )
+                {
+                    do 
+                    {
+                        if( auto Err = m_File.getC(c); Err ) 
+                            return Err;
+                    } while( c != '"' );
                 }
 
+                do
+                {
+                    if( auto Err = m_File.getC(c); Err ) 
+                        return Err;
+                } while( std::isspace(c) == false );
+
                 return {};
             };
 
+            //
+            // The line above becomes the previous line (see the ^ in ReadComponent)
+            //
+            std::swap( m_Memory, m_PrevMemory );
+            if( m_Memory.size() < m_PrevMemory.size() ) 
+                m_Memory.resize( m_PrevMemory.size() );
+
             for( m_iColumn=0; m_iColumn<m_nColumns; ++m_iColumn )
             {
                 auto& Column = m_Columns[m_iColumn];
@@ -2677,6 +6068,7 @@ namespace xtextfile
                 if( auto Err = m_File.ReadWhiteSpace(c); Err)
                     return Err;
 
+                std::swap( Column.m_FieldInfo, Column.m_PrevFieldInfo );
                 Column.m_FieldInfo.clear();
                 if( Column.m_nTypes == -1 )
                 {
@@ -2695,6 +6087,9 @@ namespace xtextfile
                             if( auto Err = m_File.getC(x); Err ) 
                                 return Err;
 
+                            if( Size >= static_cast<int>(Buffer.size()) )
+                                return xerr::create_f< state, "Found a type definition that is way too long" >();
+
                             Buffer[Size++] = x;
                         } while( std::isspace(x) == false );
 
@@ -2714,23 +6109,47 @@ namespace xtextfile
                     else
                     {
                         assert(c ==':');
+                        if( Size > static_cast<int>(D.m_SystemTypes.size()) )
+                            return xerr::create_f< state, "Found a type definition that is way too long" >();
+
                         D.m_nTypes = Strcpy_s( D.m_SystemTypes.data(), D.m_SystemTypes.size(), Buffer.data());
                         if( D.m_nTypes <= 0 )
                             return xerr::create_f< state, "Fail to read a column, type. not system types specified" >();
 
                         // Remove the null termination count
                         D.m_nTypes--;
+
+                        for( int n=0; n<D.m_nTypes; n++ )
+                        {
+                            if( isValidType( D.m_SystemTypes[n] ) == false )
+                                return xerr::create_f< state, "Found an unknown type in a column" >();
+                        }
                     }
 
                     // Read all the types
                     c = ' ';
                     for( int n=0; n<D.m_nTypes ;n++ )
                     {
+                        if( Column.m_bSkip )
+                        {
+                            if( auto Err = SkipComponent(); Err )
+                                return Err;
+                            continue;
+                        }
+
                         auto& Field = Column.m_FieldInfo.emplace_back();
                         if( auto Err = ReadComponent( Field, D.m_SystemTypes[n] ); Err )
                             return Err;
                     }
                 }
+                else if( Column.m_bSkip )
+                {
+                    for( int n=0; n<Column.m_nTypes ;n++ )
+                    {
+                        if( auto Err = SkipComponent(); Err )
+                            return Err;
+                    }
+                }
                 else
                 {
                     for( int n=0; n<Column.m_nTypes ;n++ )
@@ -2745,15 +6164,520 @@ namespace xtextfile
 
         //
         // Increment the line count
-        // reset the memory count
+        // (the memory count is left alone since deferred fields decode after the line data)
         //
         m_iLine++;
         m_iColumn   = 0;
-        m_iMemOffet = 0;
 
         return {};
     }
 
+//------------------------------------------------------------------------------
+    // Description:
+    //      Checks if every field of the binary record that we just started has a fixed size, and if
+    //      so where each field is in a row and where it goes in m_Memory (aligned to its size, the
+    //      same as when reading one field at a time). The fields are set up once for all the rows.
+    //------------------------------------------------------------------------------
+    void stream::PlanFixedRows( void ) noexcept
+    {
+        auto& Plan = m_FixedRows;
+        Plan.m_Fields.clear();
+        Plan.m_RowBytes     = 0;
+        Plan.m_nRows        = 0;
+        Plan.m_iRow         = 0;
+        Plan.m_FieldSize    = -1;
+        Plan.m_bSameLayout  = true;
+
+        int iSrc = 0;
+        int iDst = 0;
+        for( int i=0; i<m_nColumns; ++i )
+        {
+            const auto& Column = m_Columns[i];
+            if( Column.m_nTypes == -1 ) 
+                return;
+
+            for( int n=0; n<Column.m_nTypes; ++n )
+            {
+                int Size;
+                switch( Column.m_SystemTypes[n] )
+                {
+                    case 'c': case 'h':             Size = 1; break;
+                    case 'C': case 'H':             Size = 2; break;
+                    case 'f': case 'd': case 'g':   Size = 4; break;
+                    case 'F': case 'G': case 'D':   Size = 8; break;
+                    default:                        return;
+                }
+
+                iDst = align_to( iDst, Size );
+                Plan.m_Fields.push_back( { iSrc, iDst, Size } );
+                Plan.m_FieldSize = ( Plan.m_FieldSize == -1 || Plan.m_FieldSize == Size ) ? Size : 0;
+                Plan.m_bSameLayout = Plan.m_bSameLayout && iSrc == iDst;
+                iSrc += Size;
+                iDst += Size;
+            }
+        }
+
+        if( iSrc == 0 ) 
+            return;
+
+        Plan.m_RowBytes = iSrc;
+
+        if( m_Memory.size() < static_cast<std::size_t>(iDst) ) 
+            m_Memory.resize( iDst );
+
+        // The field infos do not change from row to row
+        int iField = 0;
+        for( int i=0; i<m_nColumns; ++i )
+        {
+            auto& Column = m_Columns[i];
+            Column.m_FieldInfo.clear();
+            Column.m_DynamicFields.clear();
+            for( int n=0; n<Column.m_nTypes; ++n, ++iField )
+            {
+                auto& Info = Column.m_FieldInfo.emplace_back();
+                Info.m_iData     = Plan.m_Fields[iField].m_iDst;
+                Info.m_Width     = Plan.m_Fields[iField].m_Size;
+                Info.m_bDeferred = false;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      ReadLine for binary records with fixed size rows. The rows are read from the file in
+    //      blocks of about 64KB (never past the end of the record) and each row is copied in place.
+    //------------------------------------------------------------------------------
+    xerr stream::ReadFixedRow( void ) noexcept
+    {
+        auto& Plan = m_FixedRows;
+
+        if( Plan.m_iRow == Plan.m_nRows )
+        {
+            constexpr int BlockBytes = 64 * 1024;
+            Plan.m_nRows = std::min( std::max( 1, BlockBytes / Plan.m_RowBytes ), m_Record.m_Count - m_iLine );
+            Plan.m_iRow  = 0;
+
+            const int Bytes = Plan.m_nRows * Plan.m_RowBytes;
+            if( Plan.m_Rows.size() < static_cast<std::size_t>(Bytes) ) 
+                Plan.m_Rows.resize( Bytes );
+
+            if( m_File.m_States.m_isBlocks )
+            {
+                // The rows are the same as without blocks, there is just a header in between once in a while
+                for( int iRow = 0; iRow < Plan.m_nRows; )
+                {
+                    if( m_BlockCursor.m_nLeft == 0 )
+                    {
+                        if( auto Err = ReadBlockHeader(); Err )
+                            return Err;
+
+                        if( m_BlockCursor.m_RawBytes != m_BlockCursor.m_nLeft * Plan.m_RowBytes )
+                            return xerr::create_f< state, "Found a block of rows with the wrong size" >();
+
+                        if( auto Err = UnpackBlock(); Err )
+                            return Err;
+                    }
+
+                    const int n = std::min( Plan.m_nRows - iRow, m_BlockCursor.m_nLeft );
+                    if( auto Err = m_File.Read( Plan.m_Rows[ static_cast<std::size_t>(iRow) * Plan.m_RowBytes ], n * Plan.m_RowBytes, 1 ); Err )
+                        return Err;
+
+                    m_BlockCursor.m_nLeft -= n;
+                    iRow                  += n;
+                }
+            }
+            else if( auto Err = m_File.Read( *Plan.m_Rows.data(), Bytes, 1 ); Err )
+            {
+                return Err;
+            }
+
+            //
+            // Swap the whole block at once. When all the fields have the same size it is just an
+            // array of values, otherwise each field is swapped down all the rows.
+            //
+            if( m_File.m_States.m_isEndianSwap )
+            {
+                if( Plan.m_FieldSize > 1 )
+                {
+                    endian::SwapBlock( Plan.m_Rows.data(), Bytes / Plan.m_FieldSize, Plan.m_FieldSize );
+                }
+                else if( Plan.m_FieldSize == 0 )
+                {
+                    for( const auto& Field : Plan.m_Fields )
+                        endian::SwapArray( &Plan.m_Rows[Field.m_iSrc], Plan.m_nRows, Field.m_Size, Plan.m_RowBytes );
+                }
+            }
+        }
+
+        const char* pRow = &Plan.m_Rows[ static_cast<std::size_t>(Plan.m_iRow++) * Plan.m_RowBytes ];
+        if( Plan.m_bSameLayout )
+        {
+            std::memcpy( m_Memory.data(), pRow, Plan.m_RowBytes );
+        }
+        else
+        {
+            char* pMemory = m_Memory.data();
+            for( const auto& Field : Plan.m_Fields )
+            {
+                switch( Field.m_Size )
+                {
+                    case 1: std::memcpy( &pMemory[Field.m_iDst], &pRow[Field.m_iSrc], 1 ); break;
+                    case 2: std::memcpy( &pMemory[Field.m_iDst], &pRow[Field.m_iSrc], 2 ); break;
+                    case 4: std::memcpy( &pMemory[Field.m_iDst], &pRow[Field.m_iSrc], 4 ); break;
+                    case 8: std::memcpy( &pMemory[Field.m_iDst], &pRow[Field.m_iSrc], 8 ); break;
+                }
+            }
+        }
+
+        return {};
+    }
+
+//------------------------------------------------------------------------------
+    // Description:
+    //      Binary files of revision 2 (flags::m_isWriteBlocks) have the rows of each record in
+    //      blocks, the ones that CommitLine writes at once, with this in front of them:
+    //
+    //          Bytes:u32 nRows:u32         (in the endian of the file)
+    //
+    //      The rows inside are the same as in files without blocks. Revision 3
+    //      (flags::m_isWriteCompressed) adds the size of the rows once decompressed:
+    //
+    //          Bytes:u32 nRows:u32 RawBytes:u32
+    //
+    //      Blocks that did not get smaller have Bytes == RawBytes and are not compressed.
+    //------------------------------------------------------------------------------
+    xerr stream::ReadBlockHeader( void ) noexcept
+    {
+        // The previous block may have been read from memory (see UnpackBlock)
+        m_File.m_pInput = nullptr;
+
+        std::array<std::uint32_t,3> Header;
+        if( auto Err = m_File.Read( Header, m_File.m_States.m_isCompressed ? 12 : 8 ); Err )
+            return Err;
+
+        if( m_File.m_States.m_isEndianSwap )
+            for( auto& V : Header ) V = endian::Convert(V);
+
+        if( m_File.m_States.m_isCompressed == false )
+            Header[2] = Header[0];
+
+        // Every row takes at least one byte
+        if( Header[1] == 0 || Header[1] > Header[2] || Header[0] > Header[2] || Header[2] > (1u << 30) )
+            return xerr::create_f< state, "Found a block of rows that is not valid" >();
+
+        auto& Cursor = m_BlockCursor;
+        Cursor.m_Bytes    = static_cast<int>(Header[0]);
+        Cursor.m_RawBytes = static_cast<int>(Header[2]);
+        Cursor.m_End      = m_File.Tell() + Cursor.m_Bytes;
+        Cursor.m_nRows   += static_cast<int>(Header[1]);
+        Cursor.m_nLeft    = static_cast<int>(Header[1]);
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Decompresses the block that ReadBlockHeader just read and makes the file read its
+    //      rows from m_BlockBuffer. Blocks that are not compressed are read from the file.
+    //------------------------------------------------------------------------------
+    xerr stream::UnpackBlock( void ) noexcept
+    {
+        auto& Cursor = m_BlockCursor;
+        if( Cursor.m_Bytes == Cursor.m_RawBytes )
+            return {};
+
+        m_PackedBlock.resize( Cursor.m_Bytes );
+        if( auto Err = m_File.Read( *m_PackedBlock.data(), Cursor.m_Bytes, 1 ); Err )
+            return Err;
+
+        m_BlockBuffer.resize( Cursor.m_RawBytes );
+        if( details::lz::Decompress( m_PackedBlock, m_BlockBuffer.data(), m_BlockBuffer.size() ) == false )
+            return xerr::create_f< state, "Found a compressed block that is not valid" >();
+
+        m_File.m_pInput    = m_BlockBuffer.data();
+        m_File.m_InputSize = m_BlockBuffer.size();
+        m_File.m_iInput    = 0;
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+
+    void stream::StartBlockPipeline( void ) noexcept
+    {
+        m_pDecoder = std::make_unique<details::block_pipeline>();
+
+        // Leave a core for the user thread
+        const int nWorkers = std::clamp( static_cast<int>(std::thread::hardware_concurrency()) - 1, 1, 16 );
+        for( int i=0; i<nWorkers; ++i )
+        {
+            m_pDecoder->m_Workers.emplace_back( [&Pipeline = *m_pDecoder]
+            {
+                std::unique_lock Lock( Pipeline.m_Mutex );
+                while( true )
+                {
+                    Pipeline.m_WorkReady.wait( Lock, [&]{ return Pipeline.m_bQuit || Pipeline.m_Pending.empty() == false; } );
+                    if( Pipeline.m_Pending.empty() ) 
+                        return;
+
+                    auto& Job = *Pipeline.m_Pending.front();
+                    Pipeline.m_Pending.pop_front();
+                    Lock.unlock();
+
+                    Job.m_Error = Job.m_Decoder.DecodeRows( Job );
+
+                    Lock.lock();
+                    Job.m_bDone = true;
+                    Pipeline.m_JobDone.notify_all();
+                }
+            });
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Reads whole blocks of the current record until there are about 64KB of them and
+    //      gives them to a worker, with a copy of the columns and user types to decode them.
+    //------------------------------------------------------------------------------
+    xerr stream::SubmitDecodeJob( void ) noexcept
+    {
+        auto& Pipeline = *m_pDecoder;
+
+        std::unique_ptr<details::decode_job> pJob;
+        if( Pipeline.m_FreeJobs.empty() )
+        {
+            pJob = std::make_unique<details::decode_job>();
+
+            // ReadLine counts on the room that openForReading makes
+            pJob->m_Decoder.m_Memory.resize( 1048 );
+        }
+        else
+        {
+            pJob = std::move( Pipeline.m_FreeJobs.back() );
+            Pipeline.m_FreeJobs.pop_back();
+        }
+
+        auto& Job = *pJob;
+        Job.m_Input.clear();
+        Job.m_Packed.clear();
+        Job.m_Blocks.clear();
+        Job.m_nRows = 0;
+
+        // Compressed blocks are read as they are, the worker decompresses them
+        constexpr std::size_t JobBytes = 64 * 1024;
+        std::size_t           RawBytes = 0;
+        while( RawBytes < JobBytes && m_BlockCursor.m_nRows < m_Record.m_Count )
+        {
+            if( auto Err = ReadBlockHeader(); Err )
+                return Err;
+
+            auto&             Input  = m_File.m_States.m_isCompressed ? Job.m_Packed : Job.m_Input;
+            const std::size_t iStart = Input.size();
+            Input.resize( iStart + m_BlockCursor.m_Bytes );
+            if( auto Err = m_File.Read( Input[iStart], m_BlockCursor.m_Bytes, 1 ); Err )
+                return Err;
+
+            if( m_File.m_States.m_isCompressed )
+                Job.m_Blocks.emplace_back( m_BlockCursor.m_Bytes, m_BlockCursor.m_RawBytes );
+
+            RawBytes    += m_BlockCursor.m_RawBytes;
+            Job.m_nRows += std::exchange( m_BlockCursor.m_nLeft, 0 );
+        }
+
+        //
+        // The decoder reads the rows with ReadLine as if they came from a file without blocks
+        //
+        auto& Decoder = Job.m_Decoder;
+        Decoder.m_Columns                   = m_Columns;
+        Decoder.m_nColumns                  = m_nColumns;
+        Decoder.m_UserTypes                 = m_UserTypes;
+        Decoder.m_Record.m_Count            = Job.m_nRows;
+        Decoder.m_iLine                     = 1;            // The types and the column selection are done already
+        Decoder.m_File.m_States             = m_File.m_States;
+        Decoder.m_File.m_States.m_isBlocks  = false;
+        Decoder.m_File.m_States.m_isEOF     = false;
+
+        {
+            std::scoped_lock Lock( Pipeline.m_Mutex );
+            Pipeline.m_Pending.push_back( pJob.get() );
+        }
+        Pipeline.m_WorkReady.notify_one();
+        Pipeline.m_InFlight.push_back( std::move(pJob) );
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Runs in a worker with the stream of the job (see SubmitDecodeJob). Each row is read
+    //      with ReadLine and copied out before the next one is read.
+    //------------------------------------------------------------------------------
+    xerr stream::DecodeRows( details::decode_job& Job ) noexcept
+    {
+        Job.m_Memory.clear();
+        Job.m_Fields.clear();
+        Job.m_ColumnEnds.clear();
+        Job.m_Dynamic.clear();
+
+        if( m_File.m_States.m_isCompressed )
+        {
+            std::size_t iPacked = 0;
+            for( const auto& [ Bytes, RawBytes ] : Job.m_Blocks )
+            {
+                const std::size_t iStart = Job.m_Input.size();
+                Job.m_Input.resize( iStart + RawBytes );
+
+                if( Bytes == RawBytes )
+                {
+                    std::memcpy( &Job.m_Input[iStart], &Job.m_Packed[iPacked], Bytes );
+                }
+                else if( details::lz::Decompress( { &Job.m_Packed[iPacked], static_cast<std::size_t>(Bytes) }, &Job.m_Input[iStart], RawBytes ) == false )
+                {
+                    return xerr::create_f< state, "Found a compressed block that is not valid" >();
+                }
+
+                iPacked += Bytes;
+            }
+        }
+
+        m_File.m_pInput    = Job.m_Input.data();
+        m_File.m_InputSize = Job.m_Input.size();
+        m_File.m_iInput    = 0;
+
+        for( int iRow=0; iRow<Job.m_nRows; ++iRow )
+        {
+            if( auto Err = ReadLine(); Err )
+                return Err;
+
+            // Each row starts with the same alignment that m_Memory has
+            const int iBase = align_to( static_cast<int>(Job.m_Memory.size()), 8 );
+            Job.m_Memory.resize( iBase + m_iMemOffet );
+            std::memcpy( Job.m_Memory.data() + iBase, m_Memory.data(), m_iMemOffet );
+
+            for( int i=0; i<m_nColumns; ++i )
+            {
+                const auto& Column = m_Columns[i];
+                for( auto Info : Column.m_FieldInfo )
+                {
+                    Info.m_iData += iBase;
+                    Job.m_Fields.push_back( Info );
+                }
+                Job.m_ColumnEnds.push_back( static_cast<int>(Job.m_Fields.size()) );
+
+                if( Column.m_nTypes == -1 )
+                    Job.m_Dynamic.push_back( Column.m_DynamicFields[0] );
+            }
+        }
+
+        if( m_File.m_iInput != m_File.m_InputSize )
+            return xerr::create_f< state, "Found a block with more data than its rows" >();
+
+        return {};
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      Waits for the jobs of a record that was not read to the end (ex: it was skipped)
+    //      so they can be used again.
+    //------------------------------------------------------------------------------
+    void stream::FinishDecodeJobs( void ) noexcept
+    {
+        if( m_pDecoder == nullptr )
+            return;
+
+        auto& Pipeline = *m_pDecoder;
+        if( Pipeline.m_pCurrent )
+            Pipeline.m_FreeJobs.push_back( std::move( Pipeline.m_pCurrent ) );
+
+        while( Pipeline.m_InFlight.empty() == false )
+        {
+            auto& Job = *Pipeline.m_InFlight.front();
+            {
+                std::unique_lock Lock( Pipeline.m_Mutex );
+                Pipeline.m_JobDone.wait( Lock, [&]{ return Job.m_bDone; } );
+            }
+
+            Job.m_Error.clear();
+            Job.m_bDone = false;
+
+            Pipeline.m_FreeJobs.push_back( std::move( Pipeline.m_InFlight.front() ) );
+            Pipeline.m_InFlight.pop_front();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    // Description:
+    //      ReadLine for binary records with more than one block. While the user reads the rows
+    //      of a job the workers decode the blocks that follow, so the rows only need the fields
+    //      of the columns pointed at them.
+    //------------------------------------------------------------------------------
+    xerr stream::ReadDecodedRow( void ) noexcept
+    {
+        if( m_pDecoder == nullptr )
+            StartBlockPipeline();
+
+        auto& Pipeline = *m_pDecoder;
+
+        // Don't let the workers run out of blocks
+        while( Pipeline.m_InFlight.size() < 2 * Pipeline.m_Workers.size() && m_BlockCursor.m_nRows < m_Record.m_Count )
+        {
+            if( auto Err = SubmitDecodeJob(); Err )
+                return Err;
+        }
+
+        //
+        // Move to the next job once the rows of the current one are used
+        //
+        if( Pipeline.m_pCurrent == nullptr || Pipeline.m_iRow == Pipeline.m_pCurrent->m_nRows )
+        {
+            if( Pipeline.m_pCurrent )
+                Pipeline.m_FreeJobs.push_back( std::move( Pipeline.m_pCurrent ) );
+
+            if( Pipeline.m_InFlight.empty() )
+                return xerr::create_f< state, "The blocks of the record have fewer rows than the record" >();
+
+            Pipeline.m_pCurrent = std::move( Pipeline.m_InFlight.front() );
+            Pipeline.m_InFlight.pop_front();
+
+            auto& Job = *Pipeline.m_pCurrent;
+            {
+                std::unique_lock Lock( Pipeline.m_Mutex );
+                Pipeline.m_JobDone.wait( Lock, [&]{ return Job.m_bDone; } );
+            }
+            Job.m_bDone = false;
+
+            if( Job.m_Error )
+                return std::move( Job.m_Error );
+
+            // The memory of the rows becomes ours and the job keeps the old one for its next blocks
+            m_Memory.swap( Job.m_Memory );
+            if( m_Memory.size() < 1048 ) m_Memory.resize( 1048 );
+
+            Pipeline.m_iRow     = 0;
+            Pipeline.m_iField   = 0;
+            Pipeline.m_iDynamic = 0;
+        }
+
+        //
+        // Point the columns at the row
+        //
+        auto&      Job   = *Pipeline.m_pCurrent;
+        const int* pEnds = &Job.m_ColumnEnds[ static_cast<std::size_t>(Pipeline.m_iRow) * m_nColumns ];
+        for( int i=0; i<m_nColumns; ++i )
+        {
+            auto& Column = m_Columns[i];
+            Column.m_FieldInfo.assign( Job.m_Fields.begin() + Pipeline.m_iField, Job.m_Fields.begin() + pEnds[i] );
+            Pipeline.m_iField = pEnds[i];
+
+            if( Column.m_nTypes == -1 )
+                Column.m_DynamicFields.assign( 1, Job.m_Dynamic[ Pipeline.m_iDynamic++ ] );
+        }
+        Pipeline.m_iRow++;
+
+        m_iMemOffet = static_cast<int>(m_Memory.size());
+        m_iLine++;
+        m_iColumn = 0;
+        return {};
+    }
+
 //------------------------------------------------------------------------------
     // Description:
     //      The second thing you do after the read the file is to read a record header which is what
@@ -2768,6 +6692,20 @@ namespace xtextfile
 
         assert( m_File.m_States.m_isReading );
 
+        // The workers may still be decoding blocks of the record that we are leaving
+        FinishDecodeJobs();
+        m_BlockCursor = {};
+
+        // The rest of a record that was read as a range of rows gets skipped
+        if( m_NextRecordOffset )
+        {
+            if( auto Err = m_File.SeekSet( std::exchange( m_NextRecordOffset, 0 ) ); Err )
+                return Err;
+        }
+
+        // The last block of the previous record may have been read from memory
+        m_File.m_pInput = nullptr;
+
         // if not we expect to read something
         if( m_File.m_States.m_isBinary ) 
         {
@@ -2777,6 +6715,14 @@ namespace xtextfile
                 if( auto Err = m_File.getC(c); Err ) 
                     return Err;
 
+                // The footer is not a record, for the reader the file ends here
+                if( c == '>' )
+                {
+                    m_Index.m_FooterOffset  = m_File.Tell() - 1;
+                    m_File.m_States.m_isEOF = true;
+                    return m_File.ReadingErrorCheck();
+                }
+
             } while( c != '@' && c != '[' && c != '<');
         
             //
@@ -2802,6 +6748,9 @@ namespace xtextfile
                     if( auto Err = m_File.getC(c); Err ) 
                         return Err;
 
+                    if( i >= static_cast<int>(user_defined_types{}.m_Name.size()) )
+                        return xerr::create_f< state, "A user type name was way too long, fail to read the file." >();
+
                     UserType[i++] = c;
                 }
 
@@ -2815,6 +6764,12 @@ namespace xtextfile
                         return Err;
 
                     if( c == 0 ) break;
+                    if( isValidType(c) == false ) 
+                        return xerr::create_f< state, "Found a non-atomic type in user type definition" >();
+
+                    if( i >= static_cast<int>(user_defined_types{}.m_SystemTypes.size() - 1) )
+                        return xerr::create_f< state, "A user type has way too many types, fail to read the file." >();
+
                     SystemType[i++] = c;
                 } while( true );
 
@@ -2830,6 +6785,9 @@ namespace xtextfile
 
             } while( true );
 
+            // Where the header starts, used by SkipRecord to find the record in the footer
+            m_Record.m_Offset = m_File.Tell() - 1;
+
             //
             // Deal with a record
             //
@@ -2865,13 +6823,19 @@ namespace xtextfile
             // Read the record count
             if( auto Err = m_File.Read( m_Record.m_Count ); Err ) 
                 return Err;
+
+            if( m_File.m_States.m_isEndianSwap )
+                m_Record.m_Count = endian::Convert( m_Record.m_Count );
         }
         else
         {
+            // Errors found before the name of the new record keep the previous one (ex: an extra
+            // row at the end of a record) so Validate can tell where it was
             xerr Error;
+            bool bNewName = false;
             xerr::cleanup CleanUp(Error, [&]
             {
-                m_Record.m_Name[0u]=0;
+                if( bNewName || m_File.m_States.m_isEOF ) m_Record.m_Name[0u]=0;
             });
 
             //
@@ -2884,8 +6848,9 @@ namespace xtextfile
             // Deal with user_types types
             // We read the err in case the user_types has not registered it already.
             // But the user_types should have register something....
+            // (there may be more than one block, ex: the ones written between the jobs of RecordsParallel)
             //
-            if( c == '<' )
+            while( c == '<' )
             {
                 // Read any white space
                 if( Error = m_File.ReadWhiteSpace( c ); Error ) 
@@ -2969,6 +6934,7 @@ namespace xtextfile
                 return Error;
 
             int                         NameSize = 0;
+            bNewName = true;
             do
             {
                 m_Record.m_Name[NameSize++] = c;
@@ -3058,6 +7024,9 @@ namespace xtextfile
         m_iMemOffet     = 0;
         m_nColumns      = 0;
 
+        // A column selection only lasts for one record
+        m_SelectedColumns.clear();
+
         return {};
     }
 }
@@ -6,11 +6,16 @@
 #include <array>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <assert.h>
 #include <span>
 #include <locale>
 #include <codecvt>
 #include <variant>
+#include <memory>
+#include <limits>
+#include <functional>
+#include <utility>
 
 #include "source/xerr.h"
 
@@ -70,6 +75,8 @@ namespace xtextfile
             , const char*
             , std::string*
             , std::wstring*
+            , std::string_view*
+            , std::u16string_view*
             >;
 
             //------------------------------------------------------------------------------
@@ -129,6 +136,7 @@ namespace xtextfile
     , MISMATCH_TYPES
     , FIELD_NOT_FOUND
     , UNEXPECTED_RECORD
+    , RECORD_NOT_FOUND
     };
 
     //
@@ -141,11 +149,20 @@ namespace xtextfile
 
     union flags
     {
-        std::uint8_t    m_Value = 0;
+        std::uint16_t   m_Value = 0;
         struct
         {
             bool        m_isWriteFloats:1               // Writes floating point numbers as floating point rather than hex
-            ,           m_isWriteEndianSwap:1;          // Swaps endian before writing (Only useful when writing binary)
+            ,           m_isWriteEndianSwap:1           // Swaps endian before writing (Only useful when writing binary)
+            ,           m_isWriteIndex:1                // Writes the offsets of the records used by SeekRecord (a .idx sidecar for text, a footer for binary)
+            ,           m_isWriteCompact:1              // Writes each line as soon as it is done with no column alignment (Only useful when writing text)
+            ,           m_isWriteParallel:1             // Worker threads lay out the blocks of text lines while the user keeps writing (Only useful when writing text)
+            ,           m_isWriteAlignRecord:1          // Aligns the columns with the widths of the whole record, the blocks wait in a temporary file (Only useful when writing text)
+            ,           m_isWriteAppend:1               // Adds the new records at the end of the file instead of truncating it
+            ,           m_isWriteRepeats:1              // Writes ^ for a value that is the same as the one in the line above (Only useful when writing text)
+            ,           m_isWriteIfChanged:1            // Writes a temporary file and on close only replaces the file if the contents changed
+            ,           m_isWriteBlocks:1               // Rows go in blocks that start with their size so the reader can decode them in parallel (Only useful when writing binary)
+            ,           m_isWriteCompressed:1;          // Compresses each block of rows, implies m_isWriteBlocks (Only useful when writing binary)
         };
     };
 
@@ -177,9 +194,16 @@ namespace xtextfile
                   bool            m_isView        : 1       // means we don't own the pointer
                                 , m_isEOF         : 1       // We have reach end of file so no io operations make sense after this
                                 , m_isBinary      : 1       // Tells if we are dealing with a binary file or text file
-                                , m_isEndianSwap  : 1       // Tells if when reading we should swap endians
+                                , m_isEndianSwap  : 1       // The binary file has the other endian (values are swapped when reading and writing)
                                 , m_isReading     : 1       // Tells the system whether we are reading or writing
-                                , m_isSaveFloats  : 1;      // Save floats as hex
+                                , m_isSaveFloats  : 1       // Save floats as hex
+                                , m_isWriteIndex  : 1       // Collect the record/row offsets to save the .idx sidecar (text) or the footer (binary) on close
+                                , m_isWriteCompact: 1       // Text lines are written one at a time without alignment
+                                , m_isWriteAlignRecord: 1   // Text blocks are spilled until the widths of the whole record are known
+                                , m_isWriteRepeats: 1       // Text values that are the same as the ones above are written as ^
+                                , m_isStringLength: 1       // Binary strings have their length in front rather than a terminator (revision 1)
+                                , m_isBlocks      : 1       // Binary rows come in blocks with their size and row count in front (revision 2)
+                                , m_isCompressed  : 1;      // The blocks of rows are compressed (revision 3)
             };
         };
 
@@ -188,18 +212,24 @@ namespace xtextfile
         {
             std::FILE*      m_pFP       = { nullptr };
             states          m_States    = {};
+            std::string*    m_pOutput   = { nullptr };      // When set the writes go to this buffer instead of the file
+            const char*     m_pInput    = { nullptr };      // When set the reads come from this buffer instead of the file
+            std::size_t     m_InputSize = { 0 };
+            std::size_t     m_iInput    = { 0 };            // Next byte to read from m_pInput
 
                             file                ( void )                                                                    noexcept = default;
                            ~file                ( void )                                                                    noexcept;
 
             file&           setup               ( std::FILE& File, states States )                                          noexcept;
             xerr            openForReading      ( const std::wstring_view FilePath, bool isBinary )                         noexcept;
-            xerr            openForWriting      ( const std::wstring_view FilePath, bool isBinary )                         noexcept;
+            xerr            openForWriting      ( const std::wstring_view FilePath, bool isBinary, bool bAppend = false, bool bNew = false ) noexcept;
             void            close               ( void )                                                                    noexcept;
             xerr            ReadingErrorCheck   ( void )                                                                    noexcept;
             template< typename T >
             xerr            Read                ( T& Buffer, int Size = sizeof(T), int Count = 1 )                          noexcept;
             xerr            getC                ( int& c )                                                                  noexcept;
+            void            UngetC              ( int c )                                                                   noexcept;
+            xerr            ReadVarint          ( std::uint32_t& Value )                                                    noexcept;
             xerr            WriteStr            ( std::string_view Buffer )                                                 noexcept;
             xerr            WriteFmtStr         ( const char* pFmt, ... )                                                   noexcept;
             template< typename T >
@@ -208,7 +238,9 @@ namespace xtextfile
             xerr            WriteData           ( std::string_view Buffer )                                                 noexcept;
             xerr            ReadWhiteSpace      ( int& c )                                                                  noexcept;
             xerr            HandleDynamicTable  ( int& Count )                                                              noexcept;
-            int             Tell                ()                                                                          noexcept;
+            std::int64_t    Tell                ()                                                                          noexcept;
+            xerr            Skip                ( int Count )                                                               noexcept;
+            xerr            SeekSet             ( std::int64_t Offset )                                                     noexcept;
         };
 
         //-----------------------------------------------------------------------------------------------------
@@ -217,6 +249,7 @@ namespace xtextfile
             int                                 m_IntWidth;             // Integer part 
             int                                 m_Width;                // Width of this field
             int                                 m_iData;                // Index to the data
+            bool                                m_bDeferred;            // When reading, the data is still a text token which gets decoded on demand
         };
 
         //-----------------------------------------------------------------------------------------------------
@@ -244,12 +277,18 @@ namespace xtextfile
             int                                 m_NameLength;           // string Length for Name
             std::vector<field_type>             m_DynamicFields;        // if this column has dynamic fields here is where the info is
             std::vector<field_info>             m_FieldInfo;            // All fields for this column
+            std::vector<field_info>             m_PrevFieldInfo;        // When reading text, the fields of the line above (for the values written as ^)
+            std::array<int,16>                  m_iRepeatSource;        // When writing text with repeats, the m_FieldInfo with the last value written out for each type
+            std::vector<std::string>            m_RepeatValues;         // Same for compact text, where the line above is not around anymore
             std::vector<sub_column>             m_SubColumn;            // Each of the types inside of a column is a sub_column.
 
             int                                 m_FormatNameWidth;      // Text Formatting name width 
             int                                 m_FormatTotalSubColumns;// Total width taken by the subcolumns
+            bool                                m_bSkip;                // When reading, the user did not select this column so its data is skipped
+            char                                m_FloatFormat;          // When writing text, 'f' or 'g' from the field name (Name:.3f) or 0 for the shortest form
+            int                                 m_FloatDigits;          // Digits that go with m_FloatFormat
 
-            void clear ( void ) noexcept { m_DynamicFields.clear(); m_FieldInfo.clear(); m_Name[0]=0; }
+            void clear ( void ) noexcept { m_DynamicFields.clear(); m_FieldInfo.clear(); m_PrevFieldInfo.clear(); m_Name[0]=0; m_FloatFormat=0; m_FloatDigits=0; }
         };
 
         //-----------------------------------------------------------------------------------------------------
@@ -265,9 +304,131 @@ namespace xtextfile
             int                                     m_Count             {};     // How many entries in this record
             bool                                    m_bWriteCount       {};     // If we need to write out the count
             bool                                    m_bLabel            {};     // Tells if the recrod is a label or not
+            std::int64_t                            m_iCountOffset      {};     // Binary streamed records, where the count goes once it is known
+            std::int64_t                            m_Offset            {};     // Binary reading, where the header of the record starts
+        };
+
+        //-----------------------------------------------------------------------------------------------------
+        struct text_pipeline;                                       // Worker threads used by flags::m_isWriteParallel (see the cpp)
+        struct block_pipeline;                                      // Worker threads that decode the binary blocks of flags::m_isWriteBlocks (see the cpp)
+        struct decode_job;
+        struct concurrent_record;                                   // Merges the row_blocks of stream::BeginConcurrentRecord (see the cpp)
+        struct shared_user_types;                                   // The user types that stream::RecordsParallel shares with its jobs (see the cpp)
+
+        //-----------------------------------------------------------------------------------------------------
+        // The codec of the compressed blocks of rows (binary revision 3), see the cpp
+        //-----------------------------------------------------------------------------------------------------
+        namespace lz
+        {
+            void                                    Compress            ( std::string_view Src, std::string& Dst )                  noexcept;
+            bool                                    Decompress          ( std::string_view Src, char* pDst, std::size_t DstSize )  noexcept;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        // Where the reader is in the blocks of rows of the current record (binary revision 2)
+        //-----------------------------------------------------------------------------------------------------
+        struct block_cursor
+        {
+            std::int64_t                            m_End               {};     // Offset of the file where the last block that was started ends
+            int                                     m_Bytes             {};     // Size of the rows of that block in the file
+            int                                     m_RawBytes          {};     // Same once they are decompressed
+            int                                     m_nRows             {};     // Rows of the record in the blocks that were started
+            int                                     m_nLeft             {};     // Rows of the last block that were not read from the file yet
+        };
+
+        //-----------------------------------------------------------------------------------------------------
+        // Binary records where every field has a fixed size are read many rows at a time. Each row is
+        // then copied to the places that its fields have in the memory (see stream::ReadFixedRow).
+        struct fixed_rows
+        {
+            struct field
+            {
+                int                                 m_iSrc;                 // Where the field is in a row of the file
+                int                                 m_iDst;                 // Where the field goes in stream::m_Memory
+                int                                 m_Size;
+            };
+
+            std::vector<field>                      m_Fields            {};
+            std::vector<char>                       m_Rows              {};     // The rows that were read ahead
+            int                                     m_RowBytes          {};     // Size of a row in the file, 0 when the record has no fixed size
+            int                                     m_nRows             {};     // Rows in m_Rows
+            int                                     m_iRow              {};     // Next row to use from m_Rows
+            int                                     m_FieldSize         {};     // When all the fields have the same size that size, otherwise 0
+            bool                                    m_bSameLayout       {};     // The row can be copied as a whole since the fields are already aligned
+        };
+
+        //-----------------------------------------------------------------------------------------------------
+        struct index_record
+        {
+            std::array<char,256>                    m_Name              {};     // Name of the record
+            crc32                                   m_NameCRC           {};     // CRC32 of the name (the footer of binary files only has this)
+            std::int64_t                            m_Offset            {};     // File offset from where ReadRecord will find its header
+            int                                     m_Count             {};     // How many entries in this record
+            int                                     m_iRowOffset        {};     // Where its row offsets start in record_index::m_RowOffsets
+            bool                                    m_bLabel            {};
+        };
+
+        //-----------------------------------------------------------------------------------------------------
+        // Text files keep it in their .idx sidecar, binary files in a footer (see stream::WriteFooter)
+        struct record_index
+        {
+            std::vector<index_record>               m_Records           {};
+            std::vector<std::int64_t>               m_RowOffsets        {};     // Offset of every m_nIndexRowStep-th row of each record (row 0 excluded)
+            std::int64_t                            m_FooterOffset      {};     // Binary files: where their footer starts, 0 when they don't have one
+            bool                                    m_bLoaded           {};
+
+            void clear ( void ) noexcept { m_Records.clear(); m_RowOffsets.clear(); m_FooterOffset = 0; m_bLoaded = false; }
         };
     }
 
+    //-----------------------------------------------------------------------------------------------------
+    // Rows of a record staged by one thread on its own (no locks), see stream::BeginConcurrentRecord.
+    // The values are copied so the variables given to Field can be reused right away.
+    //-----------------------------------------------------------------------------------------------------
+    class row_block
+    {
+    public:
+
+        using value = std::variant
+        < bool
+        , float, double
+        , std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t
+        , std::int8_t,  std::int16_t,  std::int32_t,  std::int64_t
+        , std::string
+        , std::wstring
+        >;
+
+        struct field
+        {
+            crc32                               m_UserType;             // if 0 then is not valid
+            const char*                         m_pName;                // Same string that stream::Field gets
+            int                                 m_iValue;               // Index of the first value in m_Values
+            int                                 m_nValues;
+        };
+
+                                        row_block           ( std::size_t iFirstRow = 0 )                                               noexcept : m_iFirstRow{ iFirstRow } {}
+
+                        template< std::size_t N, typename... T_ARGS >
+        inline          void            Field               ( crc32 UserType, const char(&pFieldName)[N], const T_ARGS&... Args )       noexcept;
+
+                        template< std::size_t N, typename... T_ARGS >
+        inline          void            Field               ( const char(&pFieldName)[N], const T_ARGS&... Args )                       noexcept;
+
+        inline          void            EndRow              ( void )                                                                    noexcept { m_RowEnds.push_back( static_cast<int>(m_Fields.size()) ); }
+        inline          void            clear               ( std::size_t iFirstRow )                                                   noexcept { m_Values.clear(); m_Fields.clear(); m_RowEnds.clear(); m_iFirstRow = iFirstRow; }
+        inline          std::size_t     getFirstRow         ( void )                                                            const   noexcept { return m_iFirstRow; }
+        inline          std::size_t     getRowCount         ( void )                                                            const   noexcept { return m_RowEnds.size(); }
+
+    protected:
+
+        std::vector<value>                                  m_Values                {};
+        std::vector<field>                                  m_Fields                {};
+        std::vector<int>                                    m_RowEnds               {};     // For each row, the index of its last field + 1
+        std::size_t                                         m_iFirstRow             {};     // Row of the record that the first row of the block is
+
+        friend class stream;
+    };
+
     //-----------------------------------------------------------------------------------------------------
     // public interface
     //-----------------------------------------------------------------------------------------------------
@@ -275,9 +436,14 @@ namespace xtextfile
     {
     public:
 
-        constexpr                       stream              ( void )                                                                    noexcept = default;
+                                        stream              ( void )                                                                    noexcept;
+                                       ~stream              ( void )                                                                    noexcept;
         void                            close               ( void )                                                                    noexcept;
                         xerr            Open                ( bool isRead, std::wstring_view View, file_type FileType, flags Flags={} ) noexcept;
+                        xerr            Validate            ( std::wstring_view FilePath )                                              noexcept;
+                        xerr            BuildIndex          ( std::wstring_view FilePath )                                              noexcept;
+                        xerr            SeekRecord          ( std::string_view RecordName, int iRow = 0, int nRows = -1 )               noexcept;
+                        xerr            SkipRecord          ( void )                                                                    noexcept;
 
                         template< std::size_t N, typename... T_ARGS >
         inline          xerr            Field               ( crc32 UserType, const char(&pFieldName)[N], T_ARGS&... Args )    noexcept;
@@ -287,6 +453,13 @@ namespace xtextfile
                         template< std::size_t N, typename... T_ARGS >
         inline          xerr            Field               ( const char(&pFieldName)[N], T_ARGS&... Args )                             noexcept;
 
+                        // Write only, for const values, temporaries, const char*, std::string_view and std::u16string_view
+                        template< std::size_t N, typename... T_ARGS >
+        inline          xerr            Field               ( crc32 UserType, const char(&pFieldName)[N], const T_ARGS&... Args ) noexcept;
+
+                        template< std::size_t N, typename... T_ARGS >
+        inline          xerr            Field               ( const char(&pFieldName)[N], const T_ARGS&... Args )                       noexcept;
+
         inline          const auto*     getUserType         ( crc32 UserType )                                         const   noexcept { if( auto I = m_UserTypeMap.find(UserType); I == m_UserTypeMap.end() ) return (details::user_types*)nullptr; else return &m_UserTypes[I->second]; }
 
                         template< std::size_t N, typename TT, typename T >
@@ -297,21 +470,43 @@ namespace xtextfile
         inline          xerr            Record              ( const char (&Str)[N]
                                                                 , T&& Callback )                                                        noexcept;
 
+                        template< std::size_t N, typename TT, typename TP, typename T >
+        inline          xerr            RecordFilter        ( const char (&Str)[N]
+                                                                , TT&& RecordStar, TP&& Predicate, T&& Callback )                       noexcept;
+
+                        template< std::size_t N, typename TM, typename T >
+        inline          xerr            RecordStream        ( const char (&Str)[N]
+                                                                , TM&& HasMore, T&& Callback )                                          noexcept;
+
+                        template< std::size_t N >
+        inline          xerr            BeginConcurrentRecord( const char (&Str)[N]
+                                                                , std::size_t Count, bool bArrivalOrder = false )                       noexcept;
+                        xerr            SubmitRows          ( row_block& Rows )                                                         noexcept;
+                        xerr            RecordsParallel     ( std::size_t nJobs
+                                                                , const std::function<void( std::size_t iJob, stream& File, xerr& Error )>& Callback ) noexcept;
+                        xerr            EndConcurrentRecord ( void )                                                                    noexcept;
+
                         template< std::size_t N >
         inline          xerr            RecordLabel         ( const char(&Str)[N] )                                                     noexcept;
 
                         xerr            WriteComment        ( const std::string_view Comment )                                  noexcept;
 
+                        void            SelectColumns       ( std::span<const std::string_view> ColumnNames )                           noexcept;
+        inline          void            SelectColumns       ( std::initializer_list<std::string_view> ColumnNames )                     noexcept { SelectColumns( std::span<const std::string_view>{ ColumnNames.begin(), ColumnNames.size() } ); }
+
 
         constexpr       bool            isReading           ( void )                                                            const   noexcept { return m_File.m_States.m_isReading; }
         constexpr       bool            isEOF               ( void )                                                            const   noexcept { return m_File.m_States.m_isEOF; }
+        constexpr       bool            isBinary            ( void )                                                            const   noexcept { return m_File.m_States.m_isBinary; }
         constexpr       bool            isWriteFloats       ( void )                                                            const   noexcept { return m_File.m_States.m_isSaveFloats; }
         inline         std::string_view getRecordName       ( void )                                                            const   noexcept { return m_Record.m_Name.data();  }
         inline          int             getRecordCount      ( void )                                                            const   noexcept { return m_Record.m_Count; }
+        inline          int             getLineIndex        ( void )                                                            const   noexcept { return m_iLine; }
         inline          int             getUserTypeCount    ( void )                                                            const   noexcept { return static_cast<int>(m_UserTypes.size()); }
                         std::uint32_t   AddUserType         ( const user_defined_types& UserType )                                      noexcept;
                         void            AddUserTypes        ( std::span<user_defined_types> UserTypes )                                 noexcept;
                         void            AddUserTypes        ( std::span<const user_defined_types> UserTypes )                           noexcept;
+                        void            AddTeeOutput        ( stream& Output )                                                          noexcept;
 
     protected:
 
@@ -325,14 +520,54 @@ namespace xtextfile
                         xerr            ReadRecord          ( void )                                                                    noexcept;
                         xerr            ReadingErrorCheck   ( void )                                                                    noexcept;
                         xerr            ReadWhiteSpace      ( int& c )                                                                  noexcept;
+                        xerr            ReadTypes           ( void )                                                                    noexcept;
                         xerr            ReadLine            ( void )                                                                    noexcept;
                         xerr            getC                ( int& c )                                                                  noexcept;
+                        xerr            DecodeNumber        ( details::field_info& Info, const char* pToken, int SystemType )           noexcept;
+                        xerr            ValidateNumber      ( const char* pToken, int Length, int SystemType )                  const   noexcept;
                         xerr            ReadColumn          ( crc32 UserType, const char* pFieldName, std::span<details::arglist::types> Args )  noexcept;
                         xerr            ReadFieldUserType   ( const char* pFieldName )                                                  noexcept;
+                        void            PlanFixedRows       ( void )                                                                    noexcept;
+                        xerr            ReadFixedRow        ( void )                                                                    noexcept;
+                        void            ApplyColumnSelection( void )                                                                    noexcept;
+                        xerr            WalkFile            ( std::wstring_view FilePath, bool bBuildIndex )                            noexcept;
+                        xerr            SaveIndex           ( void )                                                                    noexcept;
+                        xerr            ReplaceIfChanged    ( void )                                                                    noexcept;
+                        xerr            LoadIndex           ( void )                                                                    noexcept;
+                        xerr            WriteFooter         ( void )                                                                    noexcept;
+                        xerr            LoadFooter          ( void )                                                                    noexcept;
+                        void            FindCutRow          ( std::int64_t FileSize )                                                   noexcept;
+                        xerr            SkipBinaryRows      ( int iRow )                                                                noexcept;
+                        xerr            SkipTextRows        ( int iFirstRowOffset, int iRow )                                           noexcept;
+                        xerr            SkipBinaryRecord    ( void )                                                                    noexcept;
+                        xerr            SkipTextRecord      ( void )                                                                    noexcept;
+                        xerr            ReadBlockHeader     ( void )                                                                    noexcept;
+                        xerr            UnpackBlock         ( void )                                                                    noexcept;
+                        void            StartBlockPipeline  ( void )                                                                    noexcept;
+                        xerr            SubmitDecodeJob     ( void )                                                                    noexcept;
+                        void            FinishDecodeJobs    ( void )                                                                    noexcept;
+                        xerr            ReadDecodedRow      ( void )                                                                    noexcept;
+                        xerr            DecodeRows          ( details::decode_job& Job )                                                noexcept;
+                        xerr            LoadForAppend       ( std::wstring_view FilePath, file_type FileType )                          noexcept;
 
                         template< typename T >
                         xerr            Write               ( T& Buffer, int Size = sizeof(T), int Count = 1 )                          noexcept;
                         xerr            WriteLine           ( void )                                                                    noexcept;
+                        xerr            CommitLine          ( void )                                                                    noexcept;
+                        xerr            WriteCompactLine    ( void )                                                                    noexcept;
+                        xerr            WriteStreamLine     ( bool bLastLine )                                                          noexcept;
+                        xerr            OpenConcurrentRecord( const char* pHeaderName, std::size_t Count, bool bArrivalOrder )          noexcept;
+                        xerr            WriteRowBlock       ( row_block& Rows, bool bLastBlock )                                        noexcept;
+                        void            ComputeTextWidths   ( void )                                                                    noexcept;
+                        void            AddIndexEntry       ( std::int64_t Offset, bool bLabel )                                        noexcept;
+                        xerr            WriteRecordHeader   ( bool bAligned )                                                           noexcept;
+                        xerr            WriteTextBlock      ( void )                                                                    noexcept;
+                        void            StartTextPipeline   ( void )                                                                    noexcept;
+                        xerr            SubmitTextBlock     ( void )                                                                    noexcept;
+                        xerr            FlushTextBlocks     ( std::size_t nMaxInFlight )                                                noexcept;
+                        xerr            WriteLaidOut        ( std::string_view Output, details::record_index& Index )                     noexcept;
+                        xerr            SpillTextBlock      ( void )                                                                    noexcept;
+                        xerr            WriteSpilledBlocks  ( void )                                                                    noexcept;
                         xerr            WriteStr            ( std::string_view Buffer )                                                 noexcept;
                         xerr            WriteFmtStr         ( const char* pFmt, ... )                                                   noexcept;
                         xerr            WriteChar           ( char C, int Count = 1 )                                                   noexcept;
@@ -353,18 +588,39 @@ namespace xtextfile
         details::record                                     m_Record                {};     // This contains information about the current record
         std::vector<details::column>                        m_Columns               {};
         std::vector<char>                                   m_Memory                {};
+        std::vector<char>                                   m_PrevMemory            {};     // When reading text, the memory of the line above (see column::m_PrevFieldInfo)
         std::vector<details::user_types>                    m_UserTypes             {};
         std::vector<int>                                    m_DataMapping           {};
+        std::vector<std::string>                            m_SelectedColumns       {};     // When reading, the columns that the user wants to decode for the next record (empty means all)
+        details::record_index                               m_Index                 {};     // Record/row offsets of the file (see SeekRecord)
+        std::int64_t                                        m_NextRecordOffset      {};     // After a range of rows (see SeekRecord) where ReadRecord continues, 0 if not used
+        details::fixed_rows                                 m_FixedRows             {};     // When reading binary, the rows of the current record if they have a fixed size
+        details::block_cursor                               m_BlockCursor           {};     // When reading binary with blocks, the blocks of the current record
+        std::string                                         m_BlockBuffer           {};     // Binary with blocks, the rows of a block before it is written (or after it is decompressed)
+        std::string                                         m_PackedBlock           {};     // Binary with compressed blocks, the block as it is in the file
+        std::wstring                                        m_FilePath              {};     // Path of the open file, used to find its .idx sidecar
+        std::wstring                                        m_TempPath              {};     // With m_isWriteIfChanged, the file that is written until close replaces m_FilePath
+        std::unique_ptr<details::text_pipeline>             m_pPipeline             {};     // Only when writing text with flags::m_isWriteParallel
+        std::unique_ptr<details::block_pipeline>            m_pDecoder              {};     // Only when reading binary records with blocks (started on the first one)
+        std::unique_ptr<details::concurrent_record>         m_pConcurrent           {};     // Only between BeginConcurrentRecord and EndConcurrentRecord
+        std::vector<stream*>                                m_TeeOutputs            {};     // Streams that get a copy of everything that is written (see AddTeeOutput)
+        details::shared_user_types*                         m_pSharedUserTypes      {};     // Only in the jobs of RecordsParallel, where their new user types get an index
+        details::file                                       m_Spill                 {};     // Temporary file with the blocks of the current record (flags::m_isWriteAlignRecord)
         std::unordered_map<crc32, std::uint32_t>            m_UserTypeMap           {};     // First uint32 is the CRC32 of the err name
                                                                                             // Second uint32 is the index in the UserTypes vector which contains the actual data
         int                                                 m_nColumns              {};
         int                                                 m_iLine                 {};     // Which line we are in the current record
         int                                                 m_iMemOffet             {};
         int                                                 m_iColumn               {};
+        bool                                                m_bDeferDecode          {};     // When reading text, numeric fields are only decoded when the user reads them
+        bool                                                m_bValidateOnly         {};     // When reading, only check the syntax of the data without decoding it
 
         constexpr static int                                m_nSpacesBetweenFields  { 1 };
         constexpr static int                                m_nSpacesBetweenColumns { 2 };
         constexpr static int                                m_nLinesBeforeFileWrite { 64 };
+        constexpr static int                                m_nIndexRowStep         { m_nLinesBeforeFileWrite };
+        constexpr static int                                m_IndexVersion          { 1 };
+        constexpr static int                                m_UnknownCount          { std::numeric_limits<int>::max() };   // Count of a streamed record until its last line
     };
 }
 